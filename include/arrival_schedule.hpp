@@ -0,0 +1,109 @@
+#ifndef __ARRIVAL_SCHEDULE_HPP__
+#define __ARRIVAL_SCHEDULE_HPP__
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Time-varying rate of request arrivals.
+ *
+ * A schedule is a sequence of segments, each lasting a number of seconds.
+ * It is described by a string of segments separated by ';', with fields
+ * separated by ':' (rates in requests per second):
+ *
+ *   const:RATE:SECONDS                       constant rate
+ *   ramp:FROM:TO:SECONDS                     linear change of rate
+ *   burst:LOW:HIGH:ON_MS:OFF_MS:SECONDS      on/off bursts (2-state MMPP)
+ *   sine:MEAN:AMPLITUDE:PERIOD_S:SECONDS     sinusoidal (diurnal) curve
+ *
+ * Steps are consecutive 'const' segments. A 'burst' segment starts in the
+ * low state and switches between states after exponentially distributed
+ * times with means ON_MS (high) and OFF_MS (low). Switch times are drawn when
+ * the schedule is parsed, so a schedule is deterministic for a given seed.
+ *
+ * Arrivals are generated as a non-homogeneous Poisson process.
+ */
+class arrival_schedule_t
+{
+public:
+    /**
+     * @brief Parse a schedule.
+     *
+     * @param spec description of the schedule.
+     * @param seed seed used to draw burst switch times.
+     * @param schedule set if the description is valid.
+     * @param error set to a message if the description is invalid.
+     * @return true if the description is valid.
+     */
+    static bool parse(const std::string& spec, uint32_t seed, arrival_schedule_t& schedule, std::string& error);
+
+    /**
+     * @brief Rate of arrivals at a point of the schedule.
+     *
+     * @param t time in seconds since the start of the schedule.
+     * @return double requests per second, 0 after the end of the schedule.
+     */
+    double rate(double t) const noexcept;
+
+    /// Length of the schedule in seconds.
+    double duration() const noexcept { return pieces_.empty() ? 0.0 : pieces_.back().end; }
+
+    /// Expected number of arrivals over the whole schedule.
+    double expected_arrivals() const noexcept;
+
+    /**
+     * @brief Draw the next arrival of a Poisson stream following the schedule.
+     *
+     * Multiple independent streams with scales adding up to 1 together follow
+     * the schedule.
+     *
+     * @param t time in seconds of the previous arrival.
+     * @param scale fraction of the rate followed by this stream.
+     * @param rnd random engine of the stream.
+     * @return double time in seconds of the next arrival, duration() if none.
+     */
+    double next_arrival(double t, double scale, std::mt19937_64& rnd) const;
+
+private:
+    enum class shape_t : uint8_t
+    {
+        CONST = 0,
+        RAMP = 1,
+        SINE = 2
+    };
+
+    /// Part of a schedule with a single shape.
+    struct piece_t
+    {
+        double start;
+        double end;
+        shape_t shape;
+
+        /// Rate (CONST), initial rate (RAMP) or mean rate (SINE).
+        double a;
+
+        /// Final rate (RAMP) or amplitude (SINE).
+        double b;
+
+        /// Period in seconds (SINE).
+        double period;
+    };
+
+    /// Piece containing 't', nullptr after the end.
+    const piece_t* piece(double t) const noexcept;
+
+    /// Rate of a piece at 't'.
+    static double rate(const piece_t& p, double t) noexcept;
+
+    /// Upper bound of the rate of a piece.
+    static double max_rate(const piece_t& p) noexcept;
+
+    std::vector<piece_t> pieces_;
+};
+} // namespace PiBench
+#endif
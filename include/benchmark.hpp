@@ -2,15 +2,21 @@
 #define __NVM_TREE_BENCH_HPP__
 
 #include "cpucounters.h"
+#include "arrival_schedule.hpp"
+#include "calibration.hpp"
+#include "interference.hpp"
 #include "key_generator.hpp"
 #include "operation_generator.hpp"
 #include "stopwatch.hpp"
+#include "trace.hpp"
 #include "tree_api.hpp"
 #include "value_generator.hpp"
 
 #include <cstdint>
 #include <memory> // For unique_ptr
 #include <chrono> // std::chrono::high_resolution_clock::time_point
+#include <ostream>
+#include <string>
 #include <vector>
 
 namespace PiBench
@@ -40,6 +46,59 @@ enum class distribution_t : uint8_t
     ZIPFIAN = 2
 };
 
+/**
+ * @brief Distributions of random delays (think times, time-to-live).
+ *
+ */
+enum class delay_distribution_t : uint8_t
+{
+    FIXED = 0,
+    UNIFORM = 1,
+    EXPONENTIAL = 2
+};
+
+/**
+ * @brief Point queries of seek operations.
+ *
+ */
+enum class seek_t : uint8_t
+{
+    LOWER_BOUND = 0,
+    UPPER_BOUND = 1,
+    PREDECESSOR = 2
+};
+
+/**
+ * @brief Component of a mixture of key distributions.
+ *
+ */
+struct key_component_t
+{
+    distribution_t distribution;
+
+    /// Skew factor (SELFSIMILAR and ZIPFIAN).
+    float skew;
+
+    /// Weight relative to the other components.
+    double weight;
+};
+
+/**
+ * @brief Parse a mixture of key distributions.
+ *
+ * A mixture is a list of components separated by '+', each written as
+ * NAME[:SKEW][@WEIGHT] with NAME one of [UNIFORM | SELFSIMILAR | ZIPFIAN]
+ * (e.g. "ZIPFIAN:0.99@0.8+UNIFORM@0.2"). Weights default to 1, UNIFORM
+ * takes no skew.
+ *
+ * @param spec description of the mixture.
+ * @param default_skew skew of components without one.
+ * @param mixture set to the components if the description is valid.
+ * @param error set to a message if the description is invalid.
+ * @return true if the description is valid.
+ */
+bool parse_key_mixture(const std::string& spec, float default_skew, std::vector<key_component_t>& mixture, std::string& error);
+
 /**
  * @brief Benchmark options.
  *
@@ -58,6 +117,27 @@ struct options_t
     /// Number of parallel threads used for executing requests.
     uint32_t num_threads = 1;
 
+    /// Records loaded before the first checkpoint of a growth curve, doubled at each checkpoint (disabled if 0).
+    uint64_t growth_start = 0;
+
+    /// Number of lookups probing the tree at each checkpoint of a growth curve or capacity test.
+    uint64_t probe_ops = 1e6;
+
+    /// Memory in bytes the tree may use in a capacity test (disabled if 0).
+    uint64_t memory_budget = 0;
+
+    /// Memory compared to the budget: "rss" (RSS growth of the process) or "tree" (reported by the tree).
+    std::string memory_budget_source = "rss";
+
+    /// Number of records removed and reinserted or updated after load to age the tree (disabled if 0).
+    uint64_t aging_ops = 0;
+
+    /// Number of records removed before being reinserted by aging.
+    uint32_t aging_batch = 10000;
+
+    /// Ratio of aging operations that update a record instead of removing and reinserting it.
+    float aging_update_ratio = 0.0;
+
     /// Sampling window in milliseconds.
     uint32_t sampling_ms = 1000;
 
@@ -85,15 +165,93 @@ struct options_t
     /// Ratio of scan operations.
     float scan_ratio = 0.0;
 
+    /// Ratio of range aggregate operations.
+    float aggregate_ratio = 0.0;
+
+    /// Ratio of range remove operations.
+    float remove_range_ratio = 0.0;
+
+    /// Ratio of seek operations.
+    float seek_ratio = 0.0;
+
     /// Size of scan operations in records.
     uint32_t scan_size = 100;
 
+    /// Size of range aggregate operations in records.
+    uint64_t aggregate_size = 100;
+
+    /// Whether to aggregate ranges from scans even if the tree supports TREE_CAP_AGGREGATE.
+    bool aggregate_fallback = false;
+
+    /// Size of range remove operations in records.
+    uint64_t remove_range_size = 100;
+
+    /// Whether to remove ranges by scans and removes even if the tree supports TREE_CAP_REMOVE_RANGE.
+    bool remove_range_fallback = false;
+
+    /// Point query of seek operations.
+    seek_t seek_type = seek_t::LOWER_BOUND;
+
+    /// Ratio of seek operations looking for a key that is not in the tree.
+    float seek_gap_ratio = 0.0;
+
+    /// Whether to seek with scans even if the tree supports TREE_CAP_SEEK.
+    bool seek_fallback = false;
+
+    /// Whether to use the integer entry points of trees supporting TREE_CAP_U64 for 8-Byte keys and values.
+    bool typed_keys = true;
+
+    /// Number of consecutive records in key order visited by reads and updates of a thread (disabled if 0).
+    uint32_t locality_run = 0;
+
+    /// Whether to repeat the run phase with reads and inserts starting from a per-thread hint.
+    bool hints = false;
+
+    /// Whether the run phase executes multi-key transactions instead of single operations.
+    bool transactions = false;
+
+    /// Minimum number of keys accessed by a transaction.
+    uint32_t txn_min_keys = 2;
+
+    /// Maximum number of keys accessed by a transaction.
+    uint32_t txn_max_keys = 16;
+
+    /// Ratio of keys of a transaction that are written instead of read.
+    float txn_write_ratio = 0.5;
+
+    /// Number of hot records transactions contend on (disabled if 0).
+    uint64_t txn_hot_keys = 0;
+
+    /// Ratio of keys of a transaction drawn from the hot records.
+    float txn_hot_ratio = 0.5;
+
+    /// Maximum number of records per key of a multimap workload (disabled if 0).
+    uint32_t duplicates = 0;
+
+    /// Skew of the number of records per key, zipfian if above 0 and uniform otherwise.
+    float duplicate_skew = 0.0;
+
+    /// Whether removes of a multimap workload remove all records of a key instead of one.
+    bool remove_all_duplicates = false;
+
     /// Distribution used for generation random keys.
     distribution_t key_distribution = distribution_t::UNIFORM;
 
     /// Factor to be used for skewed random key distributions.
     float key_skew = 0.2;
 
+    /// Key distribution of reads (see parse_key_mixture(), key_distribution if empty).
+    std::string read_distribution = "";
+
+    /// Key distribution of updates (see parse_key_mixture(), key_distribution if empty).
+    std::string update_distribution = "";
+
+    /// Key distribution of removes (see parse_key_mixture(), key_distribution if empty).
+    std::string remove_distribution = "";
+
+    /// Key distribution of the start of scans, aggregates, range removes and seeks (see parse_key_mixture(), key_distribution if empty).
+    std::string scan_distribution = "";
+
     /// Master seed to be used for random generations.
     uint32_t rnd_seed = 1729;
 
@@ -115,6 +273,117 @@ struct options_t
     /// Generate keys which are not in the index structure (used in negative read/update)
     bool negative_access = false;
     float negative_access_rate = 0.2;
+
+    /// Whether to measure machine baselines before running.
+    bool calibrate = false;
+
+    /// File to save baselines to (with calibrate) or to load them from.
+    std::string calibration_file = "";
+
+    /// Where to run OS jitter probes: "sibling" (idle SMT sibling of each worker) or a cpu list. Disabled if empty.
+    std::string jitter_probe = "";
+
+    /// Minimum gap in nanoseconds recorded by jitter probes.
+    uint32_t jitter_threshold_ns = 5000;
+
+    /// Cpus to pin worker threads to (not pinned if empty).
+    std::string cpus = "";
+
+    /// Number of client threads submitting requests to server threads (disabled if 0).
+    uint32_t num_clients = 0;
+
+    /// Maximum number of requests a server takes from a client ring at once.
+    uint32_t batch_size = 32;
+
+    /// Maximum number of outstanding requests of a client.
+    uint32_t client_depth = 1;
+
+    /// Number of virtual clients multiplexed on each worker thread (disabled if 0).
+    uint32_t virtual_clients = 0;
+
+    /// Mean think time of virtual clients in microseconds.
+    float think_time_us = 0;
+
+    /// Distribution of think time of virtual clients.
+    delay_distribution_t think_distribution = delay_distribution_t::EXPONENTIAL;
+
+    /// Mean time-to-live in milliseconds of records inserted by the run phase (disabled if 0).
+    float ttl_ms = 0;
+
+    /// Distribution of time-to-live of inserted records.
+    delay_distribution_t ttl_distribution = delay_distribution_t::EXPONENTIAL;
+
+    /// Schedule of request arrivals of an open-loop run (see arrival_schedule_t, disabled if empty).
+    std::string arrival_schedule = "";
+
+    /// Number of threads running long scans next to the workload (disabled if 0).
+    uint32_t long_scan_threads = 0;
+
+    /// Number of records read by each long scan.
+    uint64_t long_scan_size = 1e6;
+
+    /// Number of records requested from the tree at once by long scans.
+    uint32_t long_scan_chunk = 1000;
+
+    /// Number of processes running workers against a tree attached through the pool.
+    uint32_t num_processes = 1;
+
+    /// Library of a second tree run concurrently on other cpus (disabled if empty).
+    std::string colocate_library_file = "";
+
+    /// Cpus to pin worker threads of the second tree to.
+    std::string colocate_cpus = "";
+
+    /// Path to persistent pool of the second tree.
+    std::string colocate_pool_path = "";
+
+    /// Library of a secondary index updated in lockstep with the tree (disabled if empty).
+    std::string secondary_index = "";
+
+    /// Path to persistent pool of the secondary index.
+    std::string secondary_pool_path = "";
+
+    /// Whether to repeat the run phase next to interference threads.
+    bool interference = false;
+
+    /// Memory behavior of interference threads.
+    interference_kind_t interference_kind = interference_kind_t::STREAM_READ;
+
+    /// Number of interference threads of each run.
+    std::vector<uint32_t> interference_threads = {0, 1, 2, 4};
+
+    /// Cpus to pin interference threads to (highest cpus first if empty).
+    std::string interference_cpus = "";
+
+    /// Size in Bytes of the buffer of each interference thread.
+    uint64_t interference_footprint = 1 << 28;
+};
+
+/**
+ * @brief Summary of a run phase.
+ *
+ */
+struct run_result_t
+{
+    /// Number of operations completed.
+    uint64_t operations = 0;
+
+    /// Number of operations that returned false.
+    uint64_t failed = 0;
+
+    /// Run time in milliseconds.
+    float elapsed_ms = 0;
+
+    /// Operations per second.
+    double throughput = 0;
+
+    /// Latency percentiles in nanoseconds (0 without latency sampling).
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+
+    /// Sorted latency samples in nanoseconds.
+    std::vector<uint64_t> latencies;
 };
 
 /**
@@ -125,7 +394,17 @@ struct alignas(64) stats_t
 {
     stats_t()
         : operation_count(0),
-        operation_count_F(0)
+        operation_count_F(0),
+        operation_count_expired(0),
+        records_aggregated(0),
+        records_range_removed(0),
+        range_remove_ns(0),
+        hinted_ops(0),
+        hint_hits(0),
+        seeks(0),
+        seeks_found(0),
+        seeks_exact(0),
+        ____padding{}
     {
     }
 
@@ -133,11 +412,32 @@ struct alignas(64) stats_t
     uint64_t operation_count;
     uint64_t operation_count_F;
 
+    /// Number of operations that missed an expired record.
+    uint64_t operation_count_expired;
+
+    /// Number of records in ranges of aggregate operations.
+    uint64_t records_aggregated;
+
+    /// Number of records removed by range remove operations.
+    uint64_t records_range_removed;
+
+    /// Time in nanoseconds spent in range remove operations.
+    uint64_t range_remove_ns;
+
+    /// Number of operations given a hint and number of them the tree started from the hint.
+    uint64_t hinted_ops;
+    uint64_t hint_hits;
+
+    /// Number of seek operations, of them that found a record and of them that found the key sought.
+    uint64_t seeks;
+    uint64_t seeks_found;
+    uint64_t seeks_exact;
+
     /// Vector to store both start and end time of requests.
     std::vector<std::chrono::high_resolution_clock::time_point> times;
 
     /// Padding to enforce cache-line size and avoid cache-line ping-pong.
-    uint64_t ____padding[7];
+    uint64_t ____padding[2];
 };
 
 class benchmark_t
@@ -162,17 +462,216 @@ public:
      *
      * A single thread is used for load phase to guarantee determinism across
      * multiple runs. Using multiple threads can lead to different, but
-     * equivalent, results.
+     * equivalent, results. The tree is then aged if opt.aging_ops is set.
      */
     void load() noexcept;
 
-    /// Run the workload as specified by options_t.
-    void run() noexcept;
+    /**
+     * @brief Load the tree incrementally, probing it at each checkpoint.
+     *
+     * Inserts the same records as load(), in steps ending at opt.growth_start
+     * records, twice as many, and so on up to opt.num_records. After each
+     * step, opt.num_threads threads run opt.probe_ops uniform lookups
+     * of loaded records. Prints insert and lookup throughput, lookup latency
+     * and memory per record as a function of the number of records. The tree
+     * is then aged if opt.aging_ops is set.
+     */
+    void load_growth() noexcept;
+
+    /**
+     * @brief Insert records until the memory budget is reached.
+     *
+     * Replaces the load and run phases. Inserts records in the order load()
+     * does until the memory compared to opt.memory_budget exceeds it or an
+     * insert fails (e.g. the pool is full). Each time another tenth of the
+     * budget is filled, the tree is probed with opt.probe_ops lookups. Prints
+     * the number of records that fit, memory per record at capacity and the
+     * decay of insert and lookup throughput over the fill.
+     */
+    void run_capacity() noexcept;
+
+    /**
+     * @brief Run the workload as specified by options_t.
+     *
+     * Can be called multiple times, inserts of a run do not collide with keys
+     * inserted by previous runs.
+     *
+     * @return run_result_t summary of the run.
+     */
+    run_result_t run() noexcept;
+
+    /**
+     * @brief Run the workload once for each number of interference threads.
+     *
+     * Prints the degradation of throughput and tail latency relative to the
+     * first run.
+     */
+    void run_interference() noexcept;
+
+    /**
+     * @brief Run the workload alone and then next to long scans.
+     *
+     * opt.long_scan_threads threads repeatedly scan opt.long_scan_size
+     * records from the smallest key, in chunks of opt.long_scan_chunk
+     * records. Each long scan reads from its own snapshot if the tree
+     * supports TREE_CAP_SNAPSHOT, and from the live tree otherwise. Prints
+     * scan throughput, memory held by snapshots and the degradation of
+     * throughput and tail latency of the workload.
+     */
+    void run_long_scans() noexcept;
+
+    /**
+     * @brief Run the workload without and then with hints.
+     *
+     * In the second run, each worker passes its own hint to reads and
+     * inserts. Prints the ratio of hinted operations the tree started from
+     * the hint and the throughput and latency saved. The tree must support
+     * TREE_CAP_HINT.
+     */
+    void run_hints() noexcept;
+
+    /**
+     * @brief Run opt.num_ops multi-key transactions.
+     *
+     * Each transaction accesses between opt.txn_min_keys and
+     * opt.txn_max_keys distinct loaded records, writing a ratio
+     * opt.txn_write_ratio of them and reading the others. Keys follow the
+     * key distribution of updates if written and of reads otherwise, except
+     * that a ratio opt.txn_hot_ratio of them is drawn uniformly from the
+     * first opt.txn_hot_keys records to control conflicts. Aborted
+     * transactions are retried with the same keys up to MAX_TXN_ATTEMPTS
+     * times. Prints commit throughput, abort rate and latency of
+     * transactions, including retries. The tree must support
+     * TREE_CAP_TRANSACTIONS.
+     *
+     * @return run_result_t summary of the run, failed transactions gave up.
+     */
+    run_result_t run_transactions() noexcept;
+
+    /**
+     * @brief Run opt.num_ops logical operations on the tree and a secondary
+     * index.
+     *
+     * The secondary index maps an attribute of each record to its primary
+     * key and is first loaded with an entry per loaded record. Reads look up
+     * the attribute in the secondary index and then the record in the tree,
+     * scans read opt.scan_size entries of the secondary index and look up
+     * each record. Inserts and removes write both trees, updates also move
+     * the record to a new attribute. Reads racing with an update of the same
+     * record may miss, and inserts beyond the ids reserved for a thread
+     * fail. Prints end-to-end throughput and latency, and the number of
+     * operations and sampled time spent in each index.
+     *
+     * @param secondary secondary index, its values have the size of keys.
+     * @return run_result_t summary of the logical operations.
+     */
+    run_result_t run_secondary_index(tree_api* secondary) noexcept;
+
+    /**
+     * @brief Run the workload through client and server threads.
+     *
+     * opt.num_clients client threads generate requests and submit them to
+     * their own request ring. opt.num_threads server threads own the tree and
+     * drain the rings of their clients in batches of up to opt.batch_size,
+     * returning results through a response ring per client. Latency is
+     * measured end-to-end by clients, including time spent in the rings.
+     *
+     * @return run_result_t summary of the run.
+     */
+    run_result_t run_client_server() noexcept;
+
+    /**
+     * @brief Run the workload issued by virtual clients.
+     *
+     * Each worker thread multiplexes opt.virtual_clients closed-loop clients.
+     * A client issues a request, waits for it to complete and thinks for a
+     * random time before its next request. Workers always serve the client
+     * that became ready first, so latency of a request is measured from the
+     * time its client became ready and includes waiting for the worker.
+     *
+     * @return run_result_t summary of the run.
+     */
+    run_result_t run_virtual_clients() noexcept;
+
+    /**
+     * @brief Run the workload open-loop, with requests arriving as scheduled.
+     *
+     * Each worker follows an independent Poisson stream with 1/opt.num_threads
+     * of the scheduled rate. A worker issues a request at its arrival time, or
+     * as soon as it finishes previous requests if it fell behind. Latency is
+     * measured from the arrival time, so it includes time spent in the
+     * backlog. The run lasts as long as the schedule, plus the time needed to
+     * drain the backlog.
+     *
+     * @param schedule arrival schedule.
+     * @return run_result_t summary of the run.
+     */
+    run_result_t run_schedule(const arrival_schedule_t& schedule) noexcept;
+
+    /**
+     * @brief Set the machine baselines used to normalize results.
+     *
+     * @param calibration measurements taken by calibrate() or loaded from file.
+     */
+    void set_calibration(const calibration_t& calibration) noexcept;
+
+    /**
+     * @brief Set the stream reports are printed to (std::cout by default).
+     *
+     * @param os output stream, must outlive load() and run().
+     */
+    void set_output(std::ostream& os) noexcept;
+
+    /**
+     * @brief Set whether another benchmark runs concurrently in this process.
+     *
+     * Trace counters are per thread of the process, so trace points of runs
+     * then include events of both trees and are reported as combined.
+     *
+     * @param shared whether runs are concurrent with another benchmark.
+     */
+    void set_trace_shared(bool shared) noexcept;
+
+    /**
+     * @brief Skip ids to be inserted (operation mode).
+     *
+     * Used when multiple benchmarks insert into the same tree, so their
+     * inserts do not collide.
+     *
+     * @param count number of ids to skip.
+     */
+    void skip_insert_ids(uint64_t count) noexcept;
 
     /// Maximum number of records to be scanned.
     static constexpr size_t MAX_SCAN = 1000;
 
+    /// Maximum number of attempts of an aborting transaction.
+    static constexpr uint32_t MAX_TXN_ATTEMPTS = 100;
+
 private:
+    /**
+     * @brief Age the loaded tree with opt.aging_ops random operations.
+     *
+     * Rounds remove up to opt.aging_batch random loaded records and reinsert
+     * them in shuffled order with new values, so the tree shrinks and grows
+     * again while its key set is left unchanged. A ratio of operations updates
+     * records instead. Runs single-threaded from opt.rnd_seed, so aging is
+     * deterministic. Structure statistics are printed before and after.
+     */
+    void age() noexcept;
+
+    /**
+     * @brief Run uniform lookups of loaded records on opt.num_threads threads.
+     *
+     * @param first_id id of the first loaded record.
+     * @param records number of records loaded from first_id.
+     * @return run_result_t summary of opt.probe_ops lookups, without latencies.
+     */
+    run_result_t probe_lookups(uint64_t first_id, uint64_t records) noexcept;
+
+    /// Allocate the latency buffers reused by probe_lookups().
+    void prepare_probes() noexcept;
+
     /**
     * @brief Run single operation
     *
@@ -183,6 +682,78 @@ private:
     */
     bool run_op(operation_t operation, const char * key_ptr, char * value_out, char * values_out);
 
+    /**
+     * @brief Run a read, insert, update or remove through the integer entry points.
+     *
+     * @param operation operation type.
+     * @param key integer key generated for the operation.
+     */
+    bool run_op_u64(operation_t operation, uint64_t key);
+
+    /**
+     * @brief Run the point query of a seek operation.
+     *
+     * Pushed down to the tree if it supports TREE_CAP_SEEK, done by a scan
+     * of one record (two for UPPER_BOUND) otherwise.
+     *
+     * @param key_ptr key generated for the operation.
+     * @param value_out buffer to fill with the value found.
+     * @param exact set to whether the record found has the key sought.
+     * @return true if a record was found.
+     */
+    bool run_seek(const char* key_ptr, char* value_out, bool& exact);
+
+    /**
+     * @brief Next key of the calling thread's walk over consecutive records.
+     *
+     * A walk starts by scanning opt.locality_run records from a random key,
+     * which is then returned for each of its records in key order.
+     *
+     * @param key_ptr random key generated for the operation, starts a new walk.
+     * @return const char* key of the next record of the walk.
+     */
+    const char* walk_key(const char* key_ptr);
+
+    /**
+     * @brief Run a read, insert or remove of a multimap workload.
+     *
+     * Reads find all records of the key, inserts add all records of a new
+     * key and removes remove one random record of the key, or all of them.
+     *
+     * @param operation operation type.
+     * @param key_ptr key generated for the operation.
+     */
+    bool run_multimap_op(operation_t operation, const char* key_ptr);
+
+    /**
+     * @brief Aggregate opt.aggregate_size records starting from a key.
+     *
+     * Pushed down to the tree if it supports TREE_CAP_AGGREGATE, computed
+     * from scans of up to MAX_SCAN records otherwise.
+     *
+     * @param key_ptr key generated for the operation.
+     * @param result aggregate of the range.
+     */
+    void run_aggregate(const char* key_ptr, tree_aggregate_t& result);
+
+    /**
+     * @brief Remove opt.remove_range_size records starting from a key.
+     *
+     * Pushed down to the tree if it supports TREE_CAP_REMOVE_RANGE, done by
+     * scans of up to MAX_SCAN records and a remove per record scanned
+     * otherwise.
+     *
+     * @param key_ptr key generated for the operation.
+     * @return uint64_t number of records removed.
+     */
+    uint64_t run_remove_range(const char* key_ptr);
+
+    /// Number of records of the key with the given id (multimap workload).
+    uint32_t duplicates_of(uint64_t id) const noexcept;
+
+    /// Value of the j-th record of the key with the given id, in a thread-local buffer.
+    const char* duplicate_value(uint64_t id, uint32_t j) const noexcept;
+
     /// Tree data structure being benchmarked.
     tree_api* tree_;
 
@@ -200,12 +771,77 @@ private:
 
     /// Intel PCM handler.
     PCM* pcm_;
+
+    /// Tree-internal events traced during load phase.
+    trace_snapshot_t load_trace_;
+
+    /// Machine baselines used to normalize results.
+    calibration_t calibration_;
+
+    /// Whether calibration_ holds valid measurements.
+    bool has_calibration_ = false;
+
+    /// Stream reports are printed to.
+    std::ostream* out_;
+
+    /// Cpus worker threads are pinned to.
+    std::vector<uint32_t> cpus_;
+
+    /// First id not inserted yet (operation mode).
+    uint64_t insert_id_;
+
+    /// Cumulative distribution of the number of records per key (multimap workload).
+    std::vector<double> duplicate_cdf_;
+
+    /// Latencies of each thread of probe_lookups(), reused across calls.
+    std::vector<std::vector<uint64_t>> probe_latencies_;
+
+    /// Sorted latencies of probe_lookups(), reused across calls.
+    std::vector<uint64_t> probe_sorted_;
+
+    /// Whether range aggregates are computed by the tree instead of from scans.
+    bool aggregate_pushdown_;
+
+    /// Whether range removes are done by the tree instead of by scans and removes.
+    bool remove_range_pushdown_;
+
+    /// Whether seeks are done by the tree instead of by scans.
+    bool seek_pushdown_;
+
+    /// Whether workers of run() pass hints to reads and inserts.
+    bool use_hints_ = false;
+
+    /// Whether loads and point operations use the integer entry points (TREE_CAP_U64).
+    bool u64_ = false;
+
+    /// Whether long-scan threads use the tree next to the workers of run().
+    bool long_scans_running_ = false;
+
+    /// Whether runs are concurrent with another benchmark, so trace points include its events.
+    bool trace_shared_ = false;
 };
+
+/**
+ * @brief Run two benchmarks alone and then concurrently.
+ *
+ * Both benchmarks must be loaded and should be pinned to disjoint cpus. The
+ * co-located runs are printed after both finished, followed by a comparison
+ * of solo and co-located results of each tenant.
+ *
+ * @param first benchmark of the first tenant.
+ * @param second benchmark of the second tenant.
+ * @param first_name name printed for the first tenant.
+ * @param second_name name printed for the second tenant.
+ */
+void run_colocated(benchmark_t& first, benchmark_t& second,
+                   const std::string& first_name, const std::string& second_name);
 } // namespace PiBench
 
 namespace std
 {
 std::ostream& operator<<(std::ostream& os, const PiBench::distribution_t& dist);
+std::ostream& operator<<(std::ostream& os, const PiBench::delay_distribution_t& dist);
+std::ostream& operator<<(std::ostream& os, const PiBench::seek_t& seek);
 std::ostream& operator<<(std::ostream& os, const PiBench::options_t& opt);
 } // namespace std
 
@@ -0,0 +1,95 @@
+#ifndef __CALIBRATION_HPP__
+#define __CALIBRATION_HPP__
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace PiBench
+{
+
+/**
+ * @brief Baseline measurements of the machine running the benchmark.
+ *
+ * Results of different machines can be compared by expressing tree results
+ * relative to these baselines (e.g. latency in multiples of a DRAM access).
+ * Measurements that could not be taken (e.g. remote DRAM on a single socket
+ * machine) are 0.
+ */
+struct calibration_t
+{
+    /// Working set sizes in Bytes used for pointer chasing.
+    double l1_bytes = 0;
+    double l2_bytes = 0;
+    double llc_bytes = 0;
+    double dram_bytes = 0;
+
+    /// Latency in nanoseconds of a dependent load hitting each level.
+    double l1_ns = 0;
+    double l2_ns = 0;
+    double llc_ns = 0;
+    double dram_ns = 0;
+
+    /// Latency in nanoseconds of a dependent load to memory of another NUMA node.
+    double remote_dram_ns = 0;
+
+    /// Streaming bandwidth of all threads in GB/s.
+    double read_gbs = 0;
+    double write_gbs = 0;
+
+    /// Compare-and-swap throughput on a single cache line in millions per second.
+    double cas_mops_single = 0;
+    double cas_mops_contended = 0;
+
+    /// Number of threads contending on the cache line.
+    double cas_threads = 0;
+
+    /// Cost in nanoseconds of reading the clock and the timestamp counter.
+    double clock_ns = 0;
+    double tsc_ns = 0;
+
+    /// Latency in nanoseconds of a cache line read, write + flush and page msync on the pool device.
+    double pool_read_ns = 0;
+    double pool_write_ns = 0;
+    double pool_msync_ns = 0;
+
+    /**
+     * @brief Save measurements to a text file ("name value" per line).
+     *
+     * @param path
+     * @return true if successful.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Load measurements saved by save().
+     *
+     * Fails on unknown or repeated names, values that are not numbers and
+     * missing measurements that are always taken. Measurements must be
+     * positive, except those that may not have been taken, which must not be
+     * negative. Measurements are left unchanged on failure.
+     *
+     * @param path
+     * @param error set to a message on failure.
+     * @return true if successful.
+     */
+    bool load(const std::string& path, std::string& error);
+};
+
+/**
+ * @brief Measure the baselines of the machine.
+ *
+ * @param num_threads number of threads used for bandwidth and contention tests.
+ * @param pool_path path to persistent pool, a scratch file is created next to
+ *                  it to measure the device. Skipped if empty.
+ * @return calibration_t
+ */
+calibration_t calibrate(uint32_t num_threads, const std::string& pool_path);
+} // namespace PiBench
+
+namespace std
+{
+std::ostream& operator<<(std::ostream& os, const PiBench::calibration_t& c);
+} // namespace std
+
+#endif
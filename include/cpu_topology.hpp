@@ -0,0 +1,57 @@
+#ifndef __CPU_TOPOLOGY_HPP__
+#define __CPU_TOPOLOGY_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PiBench
+{
+namespace topology
+{
+    /**
+     * @brief Parse a Linux cpu list (e.g. "0-3,8,10-11").
+     *
+     * @param list comma separated list of cpus and cpu ranges.
+     * @return std::vector<uint32_t> cpus in the order they appear.
+     */
+    std::vector<uint32_t> parse_cpu_list(const std::string& list);
+
+    /**
+     * @brief Cpus of every NUMA node, indexed by node.
+     *
+     * If the NUMA topology is not exposed, all online cpus form node 0.
+     *
+     * @return std::vector<std::vector<uint32_t>>
+     */
+    std::vector<std::vector<uint32_t>> numa_nodes();
+
+    /**
+     * @brief Hardware threads sharing a core with 'cpu' (excluding 'cpu').
+     *
+     * @param cpu
+     * @return std::vector<uint32_t>
+     */
+    std::vector<uint32_t> smt_siblings(uint32_t cpu);
+
+    /**
+     * @brief Size in Bytes of the data cache of given level seen by cpu 0.
+     *
+     * @param level cache level (1, 2 or 3).
+     * @return uint64_t size in Bytes, or 0 if unknown.
+     */
+    uint64_t cache_size(uint32_t level);
+
+    /**
+     * @brief Pin the calling thread to a single cpu.
+     *
+     * @param cpu
+     * @return true if successful.
+     */
+    bool pin_thread(uint32_t cpu);
+
+    /// Cpu the calling thread is currently running on.
+    uint32_t current_cpu();
+} // namespace topology
+} // namespace PiBench
+#endif
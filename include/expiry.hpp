@@ -0,0 +1,128 @@
+#ifndef __EXPIRY_HPP__
+#define __EXPIRY_HPP__
+
+#include "key_generator.hpp"
+#include "request_ring.hpp"
+#include "tree_api.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory> // For unique_ptr
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Background thread removing records once their time-to-live expires.
+ *
+ * Workers register each record they insert, with its time-to-live, through
+ * their own ring. The expiry thread moves registered records to a min-heap
+ * ordered by deadline and removes them from the tree in deadline order once
+ * they expire. A record is marked as expired before it is removed, so
+ * operations missing it afterwards can be told apart from unexpected misses.
+ */
+class expiry_t
+{
+public:
+    /**
+     * @brief Construct a new expiry_t object.
+     *
+     * @param tree tree to remove expired records from.
+     * @param keys generator used to materialize keys of records (operation mode).
+     * @param producers number of threads registering records.
+     * @param max_id upper bound of ids of registered records.
+     */
+    expiry_t(tree_api* tree, const key_generator_t& keys, uint32_t producers, uint64_t max_id);
+
+    /// Stops the thread if it is still running.
+    ~expiry_t();
+
+    /// Start the expiry thread.
+    void start();
+
+    /**
+     * @brief Stop the expiry thread.
+     *
+     * Records not expired yet are left in the tree and counted as pending.
+     */
+    void stop();
+
+    /**
+     * @brief Register an inserted record (producer only).
+     *
+     * Waits for the expiry thread if the ring of the producer is full.
+     *
+     * @param producer index of the calling thread.
+     * @param id id of the key of the record.
+     * @param ttl_ns time-to-live in nanoseconds from now.
+     */
+    void add(uint32_t producer, uint64_t id, int64_t ttl_ns) noexcept;
+
+    /// Whether the record with the given id expired.
+    bool expired(uint64_t id) const noexcept
+    {
+        return id < max_id_ && (expired_[id >> 6].load(std::memory_order_acquire) >> (id & 63)) & 1;
+    }
+
+    /// Number of records registered (valid after stop()).
+    uint64_t registered() const noexcept { return registered_; }
+
+    /// Number of expired records removed from the tree (valid after stop()).
+    uint64_t removed() const noexcept { return removed_; }
+
+    /// Number of expired records the tree failed to remove (valid after stop()).
+    uint64_t failed() const noexcept { return failed_; }
+
+    /// Number of records registered but not expired yet (valid after stop()).
+    uint64_t pending() const noexcept { return pending_; }
+
+    /// Number of times a producer waited for room in its ring.
+    uint64_t stalls() const noexcept { return stalls_.load(); }
+
+    /// Sorted delays in nanoseconds from deadlines to removals (valid after stop()).
+    const std::vector<uint64_t>& lag_ns() const noexcept { return lag_ns_; }
+
+private:
+    /// Record waiting for its deadline.
+    struct entry_t
+    {
+        int64_t deadline_ns;
+        uint64_t id;
+
+        bool operator>(const entry_t& other) const noexcept { return deadline_ns > other.deadline_ns; }
+    };
+
+    /// Body of the expiry thread.
+    void work();
+
+    /// Move registered records from the rings to the heap.
+    bool drain() noexcept;
+
+    tree_api* tree_;
+    const key_generator_t& keys_;
+    const uint64_t max_id_;
+
+    /// Ring of records registered by each producer.
+    std::vector<std::unique_ptr<spsc_ring_t<entry_t>>> rings_;
+
+    /// Records ordered by deadline, owned by the expiry thread.
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> heap_;
+
+    /// One bit per id, set once the record expired.
+    std::unique_ptr<std::atomic<uint64_t>[]> expired_;
+
+    std::atomic<bool> stop_;
+    std::atomic<uint64_t> stalls_;
+    std::thread thread_;
+
+    uint64_t registered_ = 0;
+    uint64_t removed_ = 0;
+    uint64_t failed_ = 0;
+    uint64_t pending_ = 0;
+    std::vector<uint64_t> lag_ns_;
+};
+} // namespace PiBench
+#endif
@@ -0,0 +1,116 @@
+#ifndef __INTERFERENCE_HPP__
+#define __INTERFERENCE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Memory behavior of interference threads.
+ *
+ */
+enum class interference_kind_t : uint8_t
+{
+    /// Sequential reads over the footprint (consumes read bandwidth).
+    STREAM_READ = 0,
+
+    /// Sequential writes over the footprint (consumes write bandwidth).
+    STREAM_WRITE = 1,
+
+    /// Read-modify-write of random cache lines (pollutes the LLC).
+    RANDOM = 2,
+
+    /// Dependent loads along a random cycle (latency bound, little bandwidth).
+    POINTER_CHASE = 3
+};
+
+/**
+ * @brief Parse the name of an interference kind.
+ *
+ * @param name one of "stream_read", "stream_write", "random" or "chase".
+ * @param kind set if the name is valid.
+ * @return true if the name is valid.
+ */
+bool parse_interference_kind(const std::string& name, interference_kind_t& kind);
+
+/**
+ * @brief Co-runner threads emulating memory-hungry neighbors.
+ *
+ * Each thread is pinned to a cpu and owns a private buffer of the given
+ * footprint, allocated and touched by the thread itself so it is placed on the
+ * thread's NUMA node. Threads keep accessing their buffer until stopped.
+ */
+class interference_t
+{
+public:
+    /**
+     * @brief Construct a new interference_t object.
+     *
+     * @param kind memory behavior of threads.
+     * @param footprint size in Bytes of the buffer of each thread.
+     */
+    interference_t(interference_kind_t kind, uint64_t footprint);
+
+    /// Stops threads that are still running.
+    ~interference_t();
+
+    /**
+     * @brief Start one thread per cpu.
+     *
+     * Returns once all threads have initialized their buffers and started
+     * accessing them.
+     *
+     * @param cpus cpus to pin threads to.
+     */
+    void start(const std::vector<uint32_t>& cpus);
+
+    /// Stop all threads.
+    void stop();
+
+    /// Bytes accessed by all threads per second while running (valid after stop()).
+    double bandwidth_gbs() const noexcept;
+
+private:
+    /// Body of a co-runner thread.
+    void work(uint32_t cpu);
+
+    /// Memory behavior of threads.
+    const interference_kind_t kind_;
+
+    /// Buffer size of each thread.
+    const uint64_t footprint_;
+
+    /// Signals threads to finish.
+    std::atomic<bool> stop_;
+
+    /// Number of threads done with initialization.
+    std::atomic<uint32_t> ready_;
+
+    /// Bytes accessed by threads that finished.
+    std::atomic<uint64_t> bytes_;
+
+    /// Prevents the compiler from eliding reads.
+    std::atomic<uint64_t> sink_;
+
+    /// Co-runner threads.
+    std::vector<std::thread> threads_;
+
+    /// Time threads were running.
+    std::chrono::high_resolution_clock::time_point start_;
+    std::chrono::high_resolution_clock::time_point stop_time_;
+};
+} // namespace PiBench
+
+namespace std
+{
+std::ostream& operator<<(std::ostream& os, const PiBench::interference_kind_t& kind);
+} // namespace std
+
+#endif
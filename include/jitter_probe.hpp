@@ -0,0 +1,95 @@
+#ifndef __JITTER_PROBE_HPP__
+#define __JITTER_PROBE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief A period in which a probe thread did not run.
+ *
+ */
+struct jitter_event_t
+{
+    /// Last time the probe ran before the gap.
+    std::chrono::high_resolution_clock::time_point start;
+
+    /// Length of the gap in nanoseconds.
+    uint64_t gap_ns;
+
+    /// Cpu the probe was pinned to.
+    uint32_t cpu;
+};
+
+/**
+ * @brief Detects OS noise (interrupts, kernel threads, THP compaction, ...).
+ *
+ * One probe thread is pinned to each given cpu and spins reading the clock.
+ * Whenever two consecutive reads are further apart than a threshold, the
+ * thread was descheduled or interrupted and the gap is recorded. Probes use
+ * the same clock as latency sampling, so both timelines can be aligned.
+ *
+ * Probes are meant to run on an idle SMT sibling of a worker, where they are
+ * exposed to the same interrupts, or on a designated idle core.
+ */
+class jitter_probe_t
+{
+public:
+    /**
+     * @brief Construct a new jitter_probe_t object.
+     *
+     * @param threshold_ns minimum gap in nanoseconds to be recorded.
+     */
+    explicit jitter_probe_t(uint64_t threshold_ns);
+
+    /// Stops probes that are still running.
+    ~jitter_probe_t();
+
+    /**
+     * @brief Start one probe thread per cpu.
+     *
+     * @param cpus cpus to pin probe threads to.
+     */
+    void start(const std::vector<uint32_t>& cpus);
+
+    /// Stop all probes and merge their events by time.
+    void stop();
+
+    /// Events of all probes sorted by start time (valid after stop()).
+    const std::vector<jitter_event_t>& events() const noexcept { return events_; }
+
+    /// Cpus probes were started on.
+    const std::vector<uint32_t>& cpus() const noexcept { return cpus_; }
+
+    /// Maximum number of events recorded per probe.
+    static constexpr size_t MAX_EVENTS = 1 << 20;
+
+private:
+    /// Body of a probe thread.
+    void probe(uint32_t cpu, std::vector<jitter_event_t>& events);
+
+    /// Minimum gap recorded.
+    const uint64_t threshold_ns_;
+
+    /// Signals probes to finish.
+    std::atomic<bool> stop_;
+
+    /// Cpus probes run on.
+    std::vector<uint32_t> cpus_;
+
+    /// Probe threads.
+    std::vector<std::thread> threads_;
+
+    /// Events recorded by each probe.
+    std::vector<std::vector<jitter_event_t>> probe_events_;
+
+    /// Events of all probes sorted by time.
+    std::vector<jitter_event_t> events_;
+};
+} // namespace PiBench
+#endif
@@ -1,14 +1,18 @@
 #ifndef __KEY_GENERATOR_HPP__
 #define __KEY_GENERATOR_HPP__
 
+#include "operation_generator.hpp"
 #include "selfsimilar_int_distribution.hpp"
 #include "zipfian_int_distribution.hpp"
 
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <memory> // For unique_ptr
 #include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace PiBench
 {
@@ -78,6 +82,31 @@ public:
      */
     virtual const char* next(uint8_t tid, bool negative_access, bool in_sequence = false) final;
 
+    /**
+     * @brief Generate next key in op mode as an integer.
+     *
+     * Same as next(), but returns the key as the integer whose native-endian
+     * bytes next() would write, without materializing it in buf_. Only valid
+     * for 8-Byte keys without prefix.
+     *
+     * @param negative_access if @true, generate a key that was not inserted.
+     * @param in_sequence if @true, keys are generated in sequence,
+     *                    if @false keys are generated randomly.
+     * @return uint64_t key.
+     */
+    uint64_t next_u64(bool negative_access, bool in_sequence = false);
+
+    /**
+     * @brief Materialize the key of a given id in op mode.
+     *
+     * Produces the same bytes as next() does when it draws 'id', but writes
+     * them to 'dst' instead of buf_, so it can be used to enumerate keys.
+     *
+     * @param id id of the key.
+     * @param dst buffer of at least size() Bytes.
+     */
+    void key_of(uint64_t id, char* dst) const;
+
     /**
      * @brief Returns total key size (including prefix and tid(time-based mode)).
      *
@@ -114,6 +143,9 @@ public:
 
     static thread_local uint64_t current_id_;
 
+    /// Id of the last key generated by next() on this thread.
+    static thread_local uint64_t last_id_;
+
     /// Storing the number of inserts with different thread ID (used as current ID)
     uint64_t* thread_stat;
 
@@ -121,12 +153,16 @@ protected:
     virtual uint64_t next_id() = 0;
     virtual uint64_t next_id(uint64_t upper_bound) = 0;
 
+    /// Composite generators draw ids from other generators.
+    friend class mixture_key_generator_t;
+    friend class operation_key_generator_t;
+
     /// Engine used for generating random numbers.
     static thread_local std::default_random_engine generator_;
 
 private:
     /// Format generated ID
-    void bits_shift(char *buf_ptr, uint64_t id);
+    void bits_shift(char *buf_ptr, uint64_t id) const;
 
     /// Seed used for generating random numbers.
     static thread_local uint32_t seed_;
@@ -223,5 +259,105 @@ private:
     zipfian_int_distribution<uint64_t> dist_;
     float skew_;
 };
+
+/**
+ * @brief Generator drawing each id from one of multiple generators, picked
+ * at random according to their weights (e.g. 80% zipfian ids and 20% uniform
+ * background ids).
+ *
+ * Only ids are drawn from the components, keys are formatted by the mixture.
+ */
+class mixture_key_generator_t final : public key_generator_t
+{
+public:
+    /**
+     * @brief Construct a new mixture_key_generator_t object
+     *
+     * @param components generators and their weights, weights need not add up to 1.
+     */
+    mixture_key_generator_t(size_t N, size_t size, uint16_t thread_num, bool tid_prefix, const std::string& prefix,
+                            std::vector<std::pair<std::unique_ptr<key_generator_t>, double>> components)
+        : key_generator_t(N, size, thread_num, tid_prefix, prefix)
+    {
+        double sum = 0;
+        for (auto& c : components)
+        {
+            sum += c.second;
+            cdf_.push_back(sum);
+            components_.push_back(std::move(c.first));
+        }
+        for (auto& c : cdf_)
+            c /= sum;
+    }
+
+    virtual uint64_t next_id() override
+    {
+        return component()->next_id();
+    }
+
+    virtual uint64_t next_id(uint64_t upper_bound) override
+    {
+        return component()->next_id(upper_bound);
+    }
+
+private:
+    /// Pick a component according to the weights.
+    key_generator_t* component()
+    {
+        double u = std::generate_canonical<double, 53>(generator_);
+        size_t i = 0;
+        while (i + 1 < cdf_.size() && u >= cdf_[i])
+            ++i;
+        return components_[i].get();
+    }
+
+    std::vector<std::unique_ptr<key_generator_t>> components_;
+
+    /// Cumulative weights of the components, normalized to 1.
+    std::vector<double> cdf_;
+};
+
+/**
+ * @brief Generator drawing ids from a different generator for each operation
+ * type.
+ *
+ * The generator of an operation type is selected by calling select() on the
+ * calling thread before generating its key. Sequences of inserted ids are
+ * kept by this generator, so all operation types see the same records.
+ */
+class operation_key_generator_t final : public key_generator_t
+{
+public:
+    /**
+     * @brief Construct a new operation_key_generator_t object
+     *
+     * @param generators generator of each operation type, indexed by operation_t.
+     */
+    operation_key_generator_t(size_t N, size_t size, uint16_t thread_num, bool tid_prefix, const std::string& prefix,
+                              std::vector<std::unique_ptr<key_generator_t>> generators)
+        : key_generator_t(N, size, thread_num, tid_prefix, prefix),
+          generators_(std::move(generators))
+    {
+    }
+
+    /// Select the generator of the next keys of the calling thread.
+    static void select(operation_t op) noexcept { selected_ = static_cast<size_t>(op); }
+
+    virtual uint64_t next_id() override
+    {
+        return generators_[selected_]->next_id();
+    }
+
+    virtual uint64_t next_id(uint64_t upper_bound) override
+    {
+        return generators_[selected_]->next_id(upper_bound);
+    }
+
+private:
+    std::vector<std::unique_ptr<key_generator_t>> generators_;
+
+    /// Operation type of the next keys of this thread.
+    static thread_local size_t selected_;
+};
 } // namespace PiBench
 #endif
\ No newline at end of file
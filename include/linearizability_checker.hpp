@@ -0,0 +1,185 @@
+#ifndef __LINEARIZABILITY_CHECKER_HPP__
+#define __LINEARIZABILITY_CHECKER_HPP__
+
+#include "utils.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Operations that can be recorded in a history.
+ *
+ */
+enum class history_op_t : uint8_t
+{
+    FIND = 0,
+    INSERT = 1,
+    UPDATE = 2,
+    REMOVE = 3
+};
+
+/**
+ * @brief A single completed operation of a concurrent history.
+ *
+ * 'invoke' and 'response' are timestamps taken right before the operation is
+ * issued and right after it returns. Two operations whose intervals overlap
+ * may be linearized in any order.
+ */
+struct history_event_t
+{
+    /// Key the operation was issued on.
+    uint64_t key;
+
+    /// Value written by INSERT/UPDATE or value returned by a successful FIND.
+    uint64_t value;
+
+    /// Timestamp of invocation.
+    uint64_t invoke;
+
+    /// Timestamp of response.
+    uint64_t response;
+
+    /// Operation type.
+    history_op_t op;
+
+    /// Value returned by the tree.
+    bool result;
+};
+
+/**
+ * @brief Per-thread buffer of history events.
+ *
+ * Buffers are preallocated so recording an event never allocates. Each
+ * thread must only touch its own recorder.
+ */
+class alignas(64) history_recorder_t
+{
+public:
+    /**
+     * @brief Construct a new history_recorder_t object.
+     *
+     * @param capacity maximum number of events to be recorded.
+     */
+    explicit history_recorder_t(size_t capacity)
+    {
+        events_.reserve(capacity);
+    }
+
+    /**
+     * @brief Take the invocation timestamp of an operation.
+     *
+     * The fence keeps the operation from starting before the timestamp is
+     * taken.
+     */
+    static uint64_t invoke() noexcept
+    {
+        auto t = utils::tsc();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return t;
+    }
+
+    /**
+     * @brief Take the response timestamp of an operation.
+     *
+     * The fence guarantees that all effects of the operation are globally
+     * visible before the timestamp is taken.
+     */
+    static uint64_t respond() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return utils::tsc();
+    }
+
+    /// Append a completed operation to the history.
+    void record(const history_event_t& e) noexcept { events_.push_back(e); }
+
+    /// Recorded events in program order.
+    const std::vector<history_event_t>& events() const noexcept { return events_; }
+
+private:
+    std::vector<history_event_t> events_;
+};
+
+/**
+ * @brief Checks that a concurrent history of a key-value map is linearizable.
+ *
+ * Linearizability is compositional, so the history is partitioned by key and
+ * each key is checked independently as a single register that can be absent
+ * or hold a value. Partitions are checked in parallel.
+ *
+ * Each partition is checked with the Wing & Gong search, extended with the
+ * memoization proposed by Lowe ("Testing for linearizability", CCPE 2017):
+ * configurations (set of linearized operations, register state) already
+ * explored are not visited again.
+ */
+class linearizability_checker_t
+{
+public:
+    /// Returns whether 'key' is present before the history starts and its value.
+    using initial_state_fn = std::function<bool(uint64_t key, uint64_t& value)>;
+
+    /**
+     * @brief Outcome of checking a history.
+     *
+     */
+    struct result_t
+    {
+        /// Number of distinct keys checked.
+        uint64_t keys = 0;
+
+        /// Number of operations checked.
+        uint64_t operations = 0;
+
+        /// Keys whose sub-history is not linearizable.
+        std::vector<uint64_t> violations;
+
+        /// Keys whose search exceeded the step budget.
+        std::vector<uint64_t> inconclusive;
+    };
+
+    /**
+     * @brief Construct a new linearizability_checker_t object.
+     *
+     * @param initial function describing the state of the map before the history.
+     * @param num_threads number of threads used to check partitions.
+     * @param max_steps search budget per key before giving up.
+     */
+    linearizability_checker_t(initial_state_fn initial, uint32_t num_threads = 1, uint64_t max_steps = 1ULL << 24);
+
+    /**
+     * @brief Check the union of the given per-thread histories.
+     *
+     * @param histories one history per thread.
+     * @return result_t
+     */
+    result_t check(const std::vector<const std::vector<history_event_t>*>& histories) const;
+
+    /**
+     * @brief Check the history of a single key.
+     *
+     * @param events all operations issued on the key, in any order.
+     * @param present whether the key exists before the history.
+     * @param value value of the key before the history.
+     * @param steps[out] number of search steps taken.
+     * @return true if the history is linearizable.
+     * @return false otherwise, or if the step budget was exceeded.
+     */
+    bool check_key(std::vector<history_event_t>& events, bool present, uint64_t value, uint64_t& steps) const;
+
+private:
+    /// State of the map before the history.
+    initial_state_fn initial_;
+
+    /// Number of threads used for checking.
+    uint32_t num_threads_;
+
+    /// Budget of search steps per key.
+    uint64_t max_steps_;
+};
+} // namespace PiBench
+#endif
@@ -0,0 +1,84 @@
+#ifndef __MULTI_PROCESS_HPP__
+#define __MULTI_PROCESS_HPP__
+
+#include "benchmark.hpp"
+#include "tree_api.hpp"
+
+#include <sys/types.h>
+
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Run the workload from multiple processes sharing one tree.
+ *
+ * Forks opt.num_processes processes when constructed, before the calling
+ * process runs any OpenMP region, since libgomp does not work in processes
+ * forked after that. Processes wait until released by run(), then each
+ * loads the tree library and attaches to the tree stored in
+ * tree_opt.pool_path by calling create_tree(), so the tree must support
+ * being opened by multiple processes at once. Each process runs
+ * opt.num_threads workers and an equal share of the operations. Processes
+ * wait on a process-shared barrier once attached, so attach and recovery
+ * costs are not measured. Results are collected in a shared anonymous
+ * mapping and printed by the calling process, which times the run by the
+ * slowest process and kills all processes and exits if one of them fails.
+ */
+class multi_process_t
+{
+public:
+    /**
+     * @brief Fork the processes, which wait until released by run().
+     *
+     * @param tree_opt tree options, including the pool to attach to.
+     * @param opt benchmark options.
+     */
+    multi_process_t(const tree_options_t& tree_opt, const options_t& opt);
+
+    /// Processes not released by run() exit without attaching to the tree.
+    ~multi_process_t();
+
+    /**
+     * @brief Release the processes and print their aggregated results.
+     *
+     * The tree must already be loaded and closed by the calling process.
+     */
+    void run();
+
+private:
+    /// Body of process 'p' once released, never returns.
+    void work(uint32_t p, int release_fd);
+
+    /// Reap all processes.
+    void wait_all();
+
+    const tree_options_t tree_opt_;
+    const options_t opt_;
+
+    /// Operations of each process, the last process also runs the remaining ones.
+    uint64_t ops_per_process_;
+    uint64_t ops_last_;
+
+    /// Ids reserved for inserts of each process.
+    uint64_t inserts_per_process_;
+
+    /// Latency samples each process can store.
+    uint64_t max_latencies_;
+
+    /// Shared anonymous mapping holding barriers, results and latencies.
+    void* mem_;
+    size_t size_;
+
+    /// Offset of the latencies of the first process in mem_.
+    size_t latencies_offset_;
+
+    /// Write end of the pipe processes wait on, closed once released.
+    int release_fd_;
+
+    /// Forked processes.
+    std::vector<pid_t> pids_;
+};
+} // namespace PiBench
+#endif
@@ -14,7 +14,10 @@ enum class operation_t : uint8_t
     INSERT = 1,
     UPDATE = 2,
     REMOVE = 3,
-    SCAN = 4
+    SCAN = 4,
+    AGGREGATE = 5,
+    REMOVE_RANGE = 6,
+    SEEK = 7
 };
 
 class operation_generator_t
@@ -28,11 +31,14 @@ public:
      * @param update ratio of update operations.
      * @param remove ratio of remove operations.
      * @param scan ratio of scan operations.
+     * @param aggregate ratio of range aggregate operations.
+     * @param remove_range ratio of range remove operations.
+     * @param seek ratio of seek operations.
      */
-    operation_generator_t(float read, float insert, float update, float remove, float scan)
+    operation_generator_t(float read, float insert, float update, float remove, float scan, float aggregate, float remove_range, float seek)
     {
         std::default_random_engine gen;
-        std::discrete_distribution<uint32_t> op_weights({read, insert, update, remove, scan});
+        std::discrete_distribution<uint32_t> op_weights({read, insert, update, remove, scan, aggregate, remove_range, seek});
 
         for(unsigned int i=0; i<ops_.size(); ++i) {
             ops_[i] = static_cast<operation_t>(op_weights(gen));
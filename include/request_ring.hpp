@@ -0,0 +1,121 @@
+#ifndef __REQUEST_RING_HPP__
+#define __REQUEST_RING_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory> // For unique_ptr
+
+namespace PiBench
+{
+
+/**
+ * @brief Bounded single-producer single-consumer ring.
+ *
+ * Producer and consumer indexes live on separate cache lines and each side
+ * caches the index of the other, so a cache line is only transferred when
+ * the ring looks full (producer) or empty (consumer). Elements are copied in
+ * and out of the slots by value.
+ *
+ * @tparam T type of elements.
+ */
+template <typename T>
+class spsc_ring_t
+{
+public:
+    /**
+     * @brief Construct a new spsc_ring_t object.
+     *
+     * @param capacity minimum number of elements, rounded up to a power of two.
+     */
+    explicit spsc_ring_t(size_t capacity)
+    {
+        capacity_ = 1;
+        while (capacity_ < capacity)
+            capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        slots_ = std::make_unique<T[]>(capacity_);
+    }
+
+    /**
+     * @brief Append an element (producer only).
+     *
+     * @param v element.
+     * @return false if the ring is full.
+     */
+    bool try_push(const T& v) noexcept
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_)
+                return false;
+        }
+        slots_[tail & mask_] = v;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove up to 'max' elements (consumer only).
+     *
+     * @param out buffer of at least 'max' elements.
+     * @param max maximum number of elements to remove.
+     * @return size_t number of elements removed.
+     */
+    size_t pop_batch(T* out, size_t max) noexcept
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ == head)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (cached_tail_ == head)
+                return 0;
+        }
+
+        size_t n = cached_tail_ - head;
+        if (n > max)
+            n = max;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = slots_[(head + i) & mask_];
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Remove one element (consumer only).
+     *
+     * @param v set to the element removed.
+     * @return false if the ring is empty.
+     */
+    bool try_pop(T& v) noexcept { return pop_batch(&v, 1) == 1; }
+
+    /// Whether the ring is empty (approximate if called by the producer).
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /// Number of slots.
+    size_t capacity() const noexcept { return capacity_; }
+
+private:
+    /// Next slot to be consumed, written by the consumer.
+    alignas(64) std::atomic<uint64_t> head_{0};
+
+    /// Consumer's copy of tail_.
+    uint64_t cached_tail_ = 0;
+
+    /// Next slot to be produced, written by the producer.
+    alignas(64) std::atomic<uint64_t> tail_{0};
+
+    /// Producer's copy of head_.
+    uint64_t cached_head_ = 0;
+
+    alignas(64) size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<T[]> slots_;
+};
+} // namespace PiBench
+#endif
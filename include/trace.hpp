@@ -0,0 +1,59 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include "trace_api.hpp"
+
+#include <cstdint>
+
+namespace PiBench
+{
+
+/**
+ * @brief Sum of the trace counters of all threads at a point in time.
+ *
+ */
+struct trace_snapshot_t
+{
+    uint64_t count[TRACE_EVENTS] = {};
+    uint64_t nanos[TRACE_EVENTS] = {};
+
+    /// Events that happened between 'before' and this snapshot.
+    trace_snapshot_t operator-(const trace_snapshot_t& before) const noexcept
+    {
+        trace_snapshot_t d;
+        for (size_t i = 0; i < TRACE_EVENTS; ++i)
+        {
+            d.count[i] = count[i] - before.count[i];
+            d.nanos[i] = nanos[i] - before.nanos[i];
+        }
+        return d;
+    }
+
+    /// Whether no event was recorded.
+    bool empty() const noexcept
+    {
+        for (size_t i = 0; i < TRACE_EVENTS; ++i)
+            if (count[i] != 0)
+                return false;
+        return true;
+    }
+};
+
+/**
+ * @brief Aggregate the trace counters of all threads.
+ *
+ * Can be called concurrently with threads recording events.
+ *
+ * @return trace_snapshot_t
+ */
+trace_snapshot_t trace_snapshot();
+
+/**
+ * @brief Human readable name of a trace event.
+ *
+ * @param e index of the event.
+ * @return const char*
+ */
+const char* trace_event_name(size_t e);
+} // namespace PiBench
+#endif
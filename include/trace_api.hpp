@@ -0,0 +1,125 @@
+/**
+ * Optional instrumentation API for tree implementations.
+ *
+ * Wrappers can count internal events (node splits, optimistic restarts, lock
+ * waits, ...) so that PiBench reports them next to throughput, per phase and
+ * per sampling window. Events are recorded with the macros below:
+ *
+ *     PIBENCH_TRACE_EVENT(trace_event_t::SPLIT);      // count one event
+ *     PIBENCH_TRACE_ADD(trace_event_t::ALLOC, n);     // count n events
+ *     PIBENCH_TRACE_SCOPE(trace_event_t::LOCK_WAIT);  // count and time scope
+ *
+ * The macros compile to nothing unless the wrapper is built with
+ * PIBENCH_TRACE defined (e.g. -DPIBENCH_TRACE). Counters are per thread and
+ * owned by PiBench, which exports pibench_trace_local() to the library. When
+ * the library is loaded by a program that does not export it, events are
+ * silently dropped.
+ */
+#ifndef __TRACE_API_HPP__
+#define __TRACE_API_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Tree-internal events that can be traced.
+ *
+ */
+enum class trace_event_t : uint8_t
+{
+    SPLIT = 0,
+    MERGE = 1,
+    RESTART = 2,
+    LOCK_WAIT = 3,
+    RETRAIN = 4,
+    FLUSH = 5,
+    ALLOC = 6,
+    COUNT = 7
+};
+
+static constexpr size_t TRACE_EVENTS = static_cast<size_t>(trace_event_t::COUNT);
+
+/**
+ * @brief Event counters of a single thread.
+ *
+ * Only the owning thread writes the counters, PiBench reads them
+ * concurrently from the monitor thread.
+ */
+struct alignas(64) trace_counters_t
+{
+    /// Number of times each event happened.
+    std::atomic<uint64_t> count[TRACE_EVENTS] = {};
+
+    /// Time in nanoseconds spent in timed scopes of each event.
+    std::atomic<uint64_t> nanos[TRACE_EVENTS] = {};
+};
+
+/// Returns the counters of the calling thread (implemented by PiBench).
+extern "C" trace_counters_t* pibench_trace_local() __attribute__((weak));
+
+#ifdef PIBENCH_TRACE
+
+/// Counters of the calling thread, or nullptr if not running under PiBench.
+inline trace_counters_t* trace_local() noexcept
+{
+    static thread_local trace_counters_t* local = pibench_trace_local ? pibench_trace_local() : nullptr;
+    return local;
+}
+
+/// Add 'n' occurrences of event 'e'.
+inline void trace_add(trace_event_t e, uint64_t n) noexcept
+{
+    auto c = trace_local();
+    if (c == nullptr)
+        return;
+    auto& counter = c->count[static_cast<size_t>(e)];
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Count an event and the time spent until the end of the scope.
+ *
+ */
+class trace_scope_t
+{
+public:
+    explicit trace_scope_t(trace_event_t e) noexcept
+        : event_(e),
+          start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~trace_scope_t()
+    {
+        auto c = trace_local();
+        if (c == nullptr)
+            return;
+        auto i = static_cast<size_t>(event_);
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        c->count[i].store(c->count[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        c->nanos[i].store(c->nanos[i].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    }
+
+private:
+    trace_event_t event_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define PIBENCH_TRACE_CONCAT_(a, b) a##b
+#define PIBENCH_TRACE_CONCAT(a, b) PIBENCH_TRACE_CONCAT_(a, b)
+#define PIBENCH_TRACE_EVENT(e) trace_add((e), 1)
+#define PIBENCH_TRACE_ADD(e, n) trace_add((e), (n))
+#define PIBENCH_TRACE_SCOPE(e) trace_scope_t PIBENCH_TRACE_CONCAT(trace_scope_, __LINE__)(e)
+
+#else
+
+#define PIBENCH_TRACE_EVENT(e) ((void)0)
+#define PIBENCH_TRACE_ADD(e, n) ((void)0)
+#define PIBENCH_TRACE_SCOPE(e) ((void)0)
+
+#endif
+
+#endif
@@ -15,7 +15,10 @@
 #ifndef __TREE_API_HPP__
 #define __TREE_API_HPP__
 
+#include "trace_api.hpp"
+
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 struct tree_options_t
@@ -27,9 +30,91 @@ struct tree_options_t
     size_t num_threads = 1;
 };
 
+/**
+ * @brief Structure statistics reported by trees implementing TREE_CAP_STATS.
+ *
+ * Fields a tree cannot compute are left to 0 and not reported.
+ */
+struct tree_stats_t
+{
+    /// Number of records stored.
+    uint64_t records = 0;
+
+    /// Number of levels, including the leaf level.
+    uint64_t height = 0;
+
+    /// Number of inner nodes.
+    uint64_t inner_nodes = 0;
+
+    /// Number of leaf nodes.
+    uint64_t leaf_nodes = 0;
+
+    /// Average ratio of used slots in leaf nodes (between 0.0 and 1.0).
+    double fill_factor = 0.0;
+
+    /// Memory in bytes used by the tree, in DRAM or in its pool.
+    uint64_t memory_bytes = 0;
+};
+
+/**
+ * @brief Aggregate of a range of records computed by trees implementing
+ * TREE_CAP_AGGREGATE.
+ *
+ * The first 8 Bytes of each value (zero-padded if values are smaller) are
+ * read as a native-endian unsigned integer. The sum wraps around.
+ */
+struct tree_aggregate_t
+{
+    /// Number of records in the range.
+    uint64_t count = 0;
+
+    /// Sum of the values.
+    uint64_t sum = 0;
+
+    /// Smallest value (UINT64_MAX if the range is empty).
+    uint64_t min = UINT64_MAX;
+
+    /// Largest value (0 if the range is empty).
+    uint64_t max = 0;
+};
+
 class tree_api;
 extern "C" tree_api* create_tree(const tree_options_t& opt);
 
+/**
+ * @brief Optional extensions a tree may implement, reported by
+ * tree_api::capabilities() as a bitmask.
+ */
+enum tree_capability_t : uint64_t
+{
+    /// snapshot_begin(), snapshot_scan(), snapshot_end() and snapshot_bytes().
+    TREE_CAP_SNAPSHOT = 1ULL << 0,
+
+    /// stats().
+    TREE_CAP_STATS = 1ULL << 1,
+
+    /// insert_dup(), find_all(), remove_one() and remove_all().
+    TREE_CAP_MULTIMAP = 1ULL << 2,
+
+    /// aggregate().
+    TREE_CAP_AGGREGATE = 1ULL << 3,
+
+    /// remove_range().
+    TREE_CAP_REMOVE_RANGE = 1ULL << 4,
+
+    /// txn_begin(), txn_read(), txn_write(), txn_commit() and txn_abort().
+    TREE_CAP_TRANSACTIONS = 1ULL << 5,
+
+    /// hint_create(), hint_destroy(), find_hint(), insert_hint() and hint_hits().
+    TREE_CAP_HINT = 1ULL << 6,
+
+    /// lower_bound(), upper_bound() and predecessor().
+    TREE_CAP_SEEK = 1ULL << 7,
+
+    /// find_u64(), insert_u64(), update_u64() and remove_u64().
+    TREE_CAP_U64 = 1ULL << 8
+};
+
 class tree_api
 {
 public:
@@ -111,6 +196,336 @@ public:
      * return scanned;
      */
     virtual int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) = 0;
+
+    /**
+     * @brief Optional extensions implemented by the tree.
+     *
+     * Methods of extensions not reported here keep their default
+     * implementation and must not be called by the framework.
+     *
+     * @return uint64_t bitmask of tree_capability_t.
+     */
+    virtual uint64_t capabilities() const { return 0; }
+
+    /**
+     * @brief Take a consistent snapshot of the tree (TREE_CAP_SNAPSHOT).
+     *
+     * Records inserted, updated or removed after the snapshot is taken must
+     * not be visible through it. Other threads keep operating on the tree
+     * while the snapshot is alive.
+     *
+     * @return void* opaque handle to the snapshot, nullptr on failure.
+     */
+    virtual void* snapshot_begin() { return nullptr; }
+
+    /**
+     * @brief Scan records of a snapshot (TREE_CAP_SNAPSHOT).
+     *
+     * Same contract as scan(), but records are read from the snapshot.
+     *
+     * @param[in] snapshot Handle returned by snapshot_begin().
+     * @param[in] key Pointer to the beginning of key of first record.
+     * @param[in] key_sz Size of key in bytes of first record.
+     * @param[in] scan_sz Amount of following records to be scanned.
+     * @param[out] values_out Pointer to location of scanned records.
+     * @return int Amount of records scanned.
+     */
+    virtual int snapshot_scan(void* snapshot, const char* key, size_t key_sz, int scan_sz, char*& values_out) { return 0; }
+
+    /**
+     * @brief Release a snapshot (TREE_CAP_SNAPSHOT).
+     *
+     * @param snapshot Handle returned by snapshot_begin().
+     */
+    virtual void snapshot_end(void* snapshot) {}
+
+    /**
+     * @brief Memory held for a snapshot (TREE_CAP_SNAPSHOT).
+     *
+     * Bytes that could be released once the snapshot ends, such as copies or
+     * old versions of records retained for it. May grow while the tree is
+     * modified.
+     *
+     * @param snapshot Handle returned by snapshot_begin().
+     * @return size_t size in bytes.
+     */
+    virtual size_t snapshot_bytes(void* snapshot) { return 0; }
+
+    /**
+     * @brief Collect structure statistics (TREE_CAP_STATS).
+     *
+     * Called while no other thread operates on the tree, so it may walk the
+     * whole structure.
+     *
+     * @param[out] stats Statistics to fill.
+     */
+    virtual void stats(tree_stats_t& stats) {}
+
+    /**
+     * @brief Insert a record even if records with the same key exist (TREE_CAP_MULTIMAP).
+     *
+     * @param key Pointer to beginning of key.
+     * @param key_sz Size of key in bytes.
+     * @param value Pointer to beginning of value.
+     * @param value_sz Size of value in bytes.
+     * @return true if record was successfully inserted.
+     */
+    virtual bool insert_dup(const char* key, size_t key_sz, const char* value, size_t value_sz) { return false; }
+
+    /**
+     * @brief Lookup all records with given key (TREE_CAP_MULTIMAP).
+     *
+     * Like scan(), the implementation sets 'values_out' to a memory region it
+     * owns, containing a contiguous sequence of <value> of the records found,
+     * in any order.
+     *
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] key_sz Size of key in bytes.
+     * @param[out] values_out Pointer to location of values found.
+     * @return int Amount of records found.
+     */
+    virtual int find_all(const char* key, size_t key_sz, char*& values_out) { return 0; }
+
+    /**
+     * @brief Remove one record with given key and value (TREE_CAP_MULTIMAP).
+     *
+     * @param key Pointer to beginning of key.
+     * @param key_sz Size of key in bytes.
+     * @param value Pointer to beginning of value.
+     * @param value_sz Size of value in bytes.
+     * @return true if a record was removed.
+     * @return false if no record has this key and value.
+     */
+    virtual bool remove_one(const char* key, size_t key_sz, const char* value, size_t value_sz) { return false; }
+
+    /**
+     * @brief Remove all records with given key (TREE_CAP_MULTIMAP).
+     *
+     * @param key Pointer to beginning of key.
+     * @param key_sz Size of key in bytes.
+     * @return int Amount of records removed.
+     */
+    virtual int remove_all(const char* key, size_t key_sz) { return 0; }
+
+    /**
+     * @brief Aggregate a range of records without copying them (TREE_CAP_AGGREGATE).
+     *
+     * The range holds the same records scan() would return for the same
+     * arguments, but only their count, sum, minimum and maximum are returned
+     * (see tree_aggregate_t). Trees keeping counts or sums in inner nodes may
+     * skip whole subtrees.
+     *
+     * @param[in] key Pointer to the beginning of key of first record.
+     * @param[in] key_sz Size of key in bytes of first record.
+     * @param[in] range_sz Amount of records in the range.
+     * @param[out] result Aggregate of the range, set to a default-constructed
+     *                    tree_aggregate_t plus the records found.
+     */
+    virtual void aggregate(const char* key, size_t key_sz, uint64_t range_sz, tree_aggregate_t& result) {}
+
+    /**
+     * @brief Remove a range of records at once (TREE_CAP_REMOVE_RANGE).
+     *
+     * The range holds the same records scan() would return for the same
+     * arguments. Trees may unlink whole subtrees instead of removing records
+     * one by one.
+     *
+     * @param key Pointer to the beginning of key of first record.
+     * @param key_sz Size of key in bytes of first record.
+     * @param range_sz Amount of records in the range.
+     * @return uint64_t Amount of records removed.
+     */
+    virtual uint64_t remove_range(const char* key, size_t key_sz, uint64_t range_sz) { return 0; }
+
+    /**
+     * @brief Start a transaction (TREE_CAP_TRANSACTIONS).
+     *
+     * Reads and writes of a transaction take effect atomically at commit,
+     * or not at all if it aborts. The handle is used by a single thread and
+     * released by txn_commit() or txn_abort().
+     *
+     * @return void* opaque handle to the transaction, nullptr on failure.
+     */
+    virtual void* txn_begin() { return nullptr; }
+
+    /**
+     * @brief Lookup record with given key in a transaction (TREE_CAP_TRANSACTIONS).
+     *
+     * Writes of the same transaction must be visible.
+     *
+     * @param[in] txn Handle returned by txn_begin().
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] key_sz Size of key in bytes.
+     * @param[out] value_out Buffer to fill with value.
+     * @return true if the key was found.
+     * @return false if the key was not found or the transaction must abort.
+     */
+    virtual bool txn_read(void* txn, const char* key, size_t key_sz, char* value_out) { return false; }
+
+    /**
+     * @brief Write a record in a transaction (TREE_CAP_TRANSACTIONS).
+     *
+     * The record is updated, or inserted if it does not exist.
+     *
+     * @param txn Handle returned by txn_begin().
+     * @param key Pointer to beginning of key.
+     * @param key_sz Size of key in bytes.
+     * @param value Pointer to beginning of value.
+     * @param value_sz Size of value in bytes.
+     * @return true if the write was accepted.
+     * @return false if the transaction must abort.
+     */
+    virtual bool txn_write(void* txn, const char* key, size_t key_sz, const char* value, size_t value_sz) { return false; }
+
+    /**
+     * @brief Commit a transaction and release its handle (TREE_CAP_TRANSACTIONS).
+     *
+     * @param txn Handle returned by txn_begin().
+     * @return true if the transaction committed.
+     * @return false if it aborted, e.g. because of a conflict.
+     */
+    virtual bool txn_commit(void* txn) { return false; }
+
+    /**
+     * @brief Abort a transaction and release its handle (TREE_CAP_TRANSACTIONS).
+     *
+     * @param txn Handle returned by txn_begin().
+     */
+    virtual void txn_abort(void* txn) {}
+
+    /**
+     * @brief Create a hint for successive nearby operations (TREE_CAP_HINT).
+     *
+     * A hint remembers where the last operation using it ended (e.g. a leaf)
+     * so the next one can start there instead of at the root. It is used by
+     * a single thread, and the tree must validate it before use since other
+     * threads may have modified the tree in between.
+     *
+     * @return void* opaque handle to the hint, nullptr on failure.
+     */
+    virtual void* hint_create() { return nullptr; }
+
+    /**
+     * @brief Release a hint (TREE_CAP_HINT).
+     *
+     * @param hint Handle returned by hint_create().
+     */
+    virtual void hint_destroy(void* hint) {}
+
+    /**
+     * @brief Lookup record with given key, starting from a hint (TREE_CAP_HINT).
+     *
+     * Same contract as find(). The hint is moved to the record visited.
+     *
+     * @param[in] hint Handle returned by hint_create().
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] sz Size of key in bytes.
+     * @param[out] value_out Buffer to fill with value.
+     * @return true if the key was found.
+     */
+    virtual bool find_hint(void* hint, const char* key, size_t sz, char* value_out) { return false; }
+
+    /**
+     * @brief Insert a record, starting from a hint (TREE_CAP_HINT).
+     *
+     * Same contract as insert(). The hint is moved to the record visited.
+     *
+     * @param hint Handle returned by hint_create().
+     * @param key Pointer to beginning of key.
+     * @param key_sz Size of key in bytes.
+     * @param value Pointer to beginning of value.
+     * @param value_sz Size of value in bytes.
+     * @return true if record was successfully inserted.
+     */
+    virtual bool insert_hint(void* hint, const char* key, size_t key_sz, const char* value, size_t value_sz) { return false; }
+
+    /**
+     * @brief Number of operations that could start from the hint (TREE_CAP_HINT).
+     *
+     * @param hint Handle returned by hint_create().
+     * @return uint64_t operations since the hint was created that did not
+     *         traverse the tree from the root.
+     */
+    virtual uint64_t hint_hits(void* hint) { return 0; }
+
+    /**
+     * @brief Lookup the first record with a key not less than the given key (TREE_CAP_SEEK).
+     *
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] key_sz Size of key in bytes.
+     * @param[out] key_out Buffer to fill with the key of the record found.
+     * @param[out] value_out Buffer to fill with the value of the record found.
+     * @return true if a record was found.
+     * @return false if all keys are less than the given key.
+     */
+    virtual bool lower_bound(const char* key, size_t key_sz, char* key_out, char* value_out) { return false; }
+
+    /**
+     * @brief Lookup the first record with a key greater than the given key (TREE_CAP_SEEK).
+     *
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] key_sz Size of key in bytes.
+     * @param[out] key_out Buffer to fill with the key of the record found.
+     * @param[out] value_out Buffer to fill with the value of the record found.
+     * @return true if a record was found.
+     * @return false if no key is greater than the given key.
+     */
+    virtual bool upper_bound(const char* key, size_t key_sz, char* key_out, char* value_out) { return false; }
+
+    /**
+     * @brief Lookup the last record with a key not greater than the given key (TREE_CAP_SEEK).
+     *
+     * @param[in] key Pointer to beginning of key.
+     * @param[in] key_sz Size of key in bytes.
+     * @param[out] key_out Buffer to fill with the key of the record found.
+     * @param[out] value_out Buffer to fill with the value of the record found.
+     * @return true if a record was found.
+     * @return false if all keys are greater than the given key.
+     */
+    virtual bool predecessor(const char* key, size_t key_sz, char* key_out, char* value_out) { return false; }
+
+    /**
+     * @brief Lookup record with given integer key (TREE_CAP_U64).
+     *
+     * Typed entry points are used instead of find(), insert(), update() and
+     * remove() when keys and values are 8 Bytes. Keys and values are the
+     * integers whose native-endian bytes are passed to the other methods, so
+     * both kinds of calls operate on the same records.
+     *
+     * @param[in] key Key.
+     * @param[out] value_out Value found.
+     * @return true if the key was found.
+     */
+    virtual bool find_u64(uint64_t key, uint64_t& value_out) { return false; }
+
+    /**
+     * @brief Insert a record with given integer key and value (TREE_CAP_U64).
+     *
+     * @param key Key.
+     * @param value Value.
+     * @return true if record was successfully inserted.
+     * @return false if record was not inserted because it already exists.
+     */
+    virtual bool insert_u64(uint64_t key, uint64_t value) { return false; }
+
+    /**
+     * @brief Update the record with given integer key (TREE_CAP_U64).
+     *
+     * @param key Key.
+     * @param value New value.
+     * @return true if record was successfully updated.
+     * @return false if record was not updated because it does not exist.
+     */
+    virtual bool update_u64(uint64_t key, uint64_t value) { return false; }
+
+    /**
+     * @brief Remove the record with given integer key (TREE_CAP_U64).
+     *
+     * @param key Key.
+     * @return true if key was successfully removed.
+     * @return false if key did not exist.
+     */
+    virtual bool remove_u64(uint64_t key) { return false; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,143 @@
+#ifndef __TREE_ORACLE_HPP__
+#define __TREE_ORACLE_HPP__
+
+#include "key_generator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace PiBench
+{
+
+/**
+ * @brief Expected state of a tree loaded with keys derived from dense ids.
+ *
+ * Instead of mirroring the tree with another map, the oracle keeps 4 Bytes
+ * per id in [1, N]: a presence bit and a 31 bit version that is bumped by
+ * every successful write. Keys are materialized with the same key generator
+ * used by PiBench and values are a deterministic function of (id, version),
+ * so neither has to be stored. A version that wraps makes an old value
+ * current again, so wrapped() must be checked.
+ *
+ * Scans are checked against a sorted array of ids, built once. Keys of 4 or 8
+ * Bytes without prefix are ordered as native integers (as in the stlmap
+ * wrapper); all other keys are ordered byte-wise.
+ *
+ * Ids are independent, so threads may concurrently modify disjoint ids.
+ */
+class tree_oracle_t
+{
+public:
+    /**
+     * @brief Construct a new tree_oracle_t object.
+     *
+     * @param num_ids number of ids tracked, ids are in range [1, num_ids].
+     * @param key_size size in Bytes of keys (excluding prefix).
+     * @param value_size size in Bytes of values.
+     * @param prefix prefix prepended to every key.
+     * @param seed seed used to derive values.
+     */
+    tree_oracle_t(uint64_t num_ids, uint32_t key_size, uint32_t value_size, const std::string& prefix, uint32_t seed);
+
+    /// Number of ids tracked.
+    uint64_t size() const noexcept { return state_.size(); }
+
+    /// Total key size in Bytes (including prefix).
+    size_t key_size() const noexcept { return keys_.size(); }
+
+    /// Value size in Bytes.
+    uint32_t value_size() const noexcept { return value_size_; }
+
+    /// Materialize key of 'id' into 'dst'.
+    void key(uint64_t id, char* dst) const { keys_.key_of(id, dst); }
+
+    /// Materialize current value of 'id' into 'dst'.
+    void value(uint64_t id, char* dst) const;
+
+    /// Whether 'id' is expected to be in the tree.
+    bool present(uint64_t id) const noexcept { return state_[id - 1] & PRESENT; }
+
+    /**
+     * @brief Apply an insert of 'id' with its next value.
+     *
+     * @return expected result of the insert in the tree.
+     */
+    bool insert(uint64_t id) noexcept;
+
+    /**
+     * @brief Apply an update of 'id' with its next value.
+     *
+     * @return expected result of the update in the tree.
+     */
+    bool update(uint64_t id) noexcept;
+
+    /**
+     * @brief Apply a remove of 'id'.
+     *
+     * @return expected result of the remove in the tree.
+     */
+    bool remove(uint64_t id) noexcept;
+
+    /**
+     * @brief Build the sorted array of ids used for checking scans.
+     *
+     * @param num_threads number of threads used for sorting.
+     */
+    void sort(uint32_t num_threads);
+
+    /**
+     * @brief Ids expected to be returned by a scan starting at key of 'id'.
+     *
+     * Requires sort() to be called before.
+     *
+     * @param id id of the first key, which does not need to be present.
+     * @param scan_sz maximum number of records scanned.
+     * @param ids_out buffer of at least 'scan_sz' ids.
+     * @return size_t number of ids expected.
+     */
+    size_t scan(uint64_t id, size_t scan_sz, uint64_t* ids_out) const;
+
+    /// Whether keys are ordered as native integers.
+    bool integer_order() const noexcept { return integer_order_; }
+
+    /// Whether the version of an id wrapped, after which lost updates may go undetected.
+    bool wrapped() const noexcept { return wrapped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t VERSION_BITS = 31;
+    static constexpr uint32_t PRESENT = 1u << VERSION_BITS;
+    static constexpr uint32_t VERSION_MASK = PRESENT - 1;
+
+    /// Present state with the version following the one in 's'.
+    uint32_t next_version(uint32_t s) noexcept;
+
+    /// Position of the key of 'id' in the key order of the tree.
+    uint64_t rank(uint64_t id) const noexcept;
+
+    /// Presence bit and version of every id.
+    std::vector<uint32_t> state_;
+
+    /// Set once the version of any id wrapped.
+    std::atomic<bool> wrapped_;
+
+    /// Ids sorted by key order.
+    std::vector<uint64_t> order_;
+
+    /// Generator used to materialize keys.
+    uniform_key_generator_t keys_;
+
+    /// Size in Bytes of keys (excluding prefix).
+    const uint32_t key_size_;
+
+    /// Size in Bytes of values.
+    const uint32_t value_size_;
+
+    /// Seed used to derive values.
+    const uint32_t seed_;
+
+    /// Whether keys are ordered as native integers or byte-wise.
+    const bool integer_order_;
+};
+} // namespace PiBench
+#endif
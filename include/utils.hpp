@@ -1,7 +1,18 @@
 #ifndef __UTILS_HPP__
 #define __UTILS_HPP__
 
+#include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <fstream>
+#include <type_traits>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace PiBench
 {
@@ -124,6 +135,42 @@ namespace utils
         return bint.c[0] == 1;
     }
 
+    /**
+     * @brief Read the timestamp counter.
+     *
+     * Uses RDTSCP on x86, which waits for all previous instructions to
+     * execute before reading the counter. Timestamps are only comparable
+     * across cores on processors with an invariant TSC. Other architectures
+     * fall back to a monotonic clock in nanoseconds.
+     *
+     * @return uint64_t
+     */
+    static inline uint64_t tsc() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned int aux;
+        return __rdtscp(&aux);
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Resident set size of the process.
+     *
+     * @return uint64_t size in Bytes, 0 if it cannot be read.
+     */
+    static inline uint64_t rss_bytes() noexcept
+    {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t size = 0;
+        uint64_t resident = 0;
+        if (!(statm >> size >> resident))
+            return 0;
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
     /**
      * @brief Read memory without optimizing out.
      *
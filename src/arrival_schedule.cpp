@@ -0,0 +1,226 @@
+#include "arrival_schedule.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PiBench
+{
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+
+/// Split 's' at every 'sep'.
+std::vector<std::string> split(const std::string& s, char sep)
+{
+    std::vector<std::string> parts;
+    size_t pos = 0;
+    while (true)
+    {
+        auto end = s.find(sep, pos);
+        parts.push_back(s.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        if (end == std::string::npos)
+            break;
+        pos = end + 1;
+    }
+    return parts;
+}
+} // namespace
+
+bool arrival_schedule_t::parse(const std::string& spec, uint32_t seed, arrival_schedule_t& schedule, std::string& error)
+{
+    std::mt19937_64 rnd(seed);
+    std::vector<piece_t> pieces;
+    double t = 0;
+
+    for (auto& segment : split(spec, ';'))
+    {
+        if (segment.empty())
+            continue;
+
+        auto fields = split(segment, ':');
+        std::vector<double> v;
+        try
+        {
+            for (size_t i = 1; i < fields.size(); ++i)
+                v.push_back(std::stod(fields[i]));
+        }
+        catch (const std::exception&)
+        {
+            error = "invalid number in segment '" + segment + "'";
+            return false;
+        }
+
+        if (std::any_of(v.begin(), v.end(), [](double x) { return !(x >= 0.0); }))
+        {
+            error = "negative value in segment '" + segment + "'";
+            return false;
+        }
+
+        auto& kind = fields[0];
+        size_t expected = kind == "const" ? 2 : kind == "ramp" ? 3 : kind == "burst" ? 5 : kind == "sine" ? 4 : 0;
+        if (expected == 0)
+        {
+            error = "unknown segment '" + kind + "', must be one of [const | ramp | burst | sine]";
+            return false;
+        }
+        if (v.size() != expected)
+        {
+            error = "segment '" + segment + "' must have " + std::to_string(expected) + " values";
+            return false;
+        }
+
+        double seconds = v.back();
+        if (seconds <= 0.0)
+        {
+            error = "segment '" + segment + "' must last more than 0 seconds";
+            return false;
+        }
+
+        if (kind == "const")
+        {
+            pieces.push_back({t, t + seconds, shape_t::CONST, v[0], 0, 0});
+        }
+        else if (kind == "ramp")
+        {
+            pieces.push_back({t, t + seconds, shape_t::RAMP, v[0], v[1], 0});
+        }
+        else if (kind == "sine")
+        {
+            if (v[1] > v[0] || v[2] <= 0.0)
+            {
+                error = "segment '" + segment + "' must have an amplitude not above the mean and a period above 0";
+                return false;
+            }
+            pieces.push_back({t, t + seconds, shape_t::SINE, v[0], v[1], v[2]});
+        }
+        else // burst
+        {
+            if (v[2] <= 0.0 || v[3] <= 0.0)
+            {
+                error = "segment '" + segment + "' must have on and off times above 0";
+                return false;
+            }
+
+            // Expand into constant pieces at the drawn switch times.
+            double end = t + seconds;
+            double s = t;
+            bool high = false;
+            while (s < end)
+            {
+                double mean = (high ? v[2] : v[3]) / 1000.0;
+                double dwell = -mean * std::log(1.0 - std::generate_canonical<double, 53>(rnd));
+                double e = std::min(end, s + dwell);
+                if (e > s)
+                    pieces.push_back({s, e, shape_t::CONST, high ? v[1] : v[0], 0, 0});
+                s = e;
+                high = !high;
+            }
+        }
+        t += seconds;
+    }
+
+    if (pieces.empty())
+    {
+        error = "schedule is empty";
+        return false;
+    }
+
+    schedule.pieces_ = std::move(pieces);
+    return true;
+}
+
+const arrival_schedule_t::piece_t* arrival_schedule_t::piece(double t) const noexcept
+{
+    if (pieces_.empty() || t < 0.0 || t >= pieces_.back().end)
+        return nullptr;
+
+    auto it = std::upper_bound(pieces_.begin(), pieces_.end(), t,
+                               [](double x, const piece_t& p) { return x < p.end; });
+    return &*it;
+}
+
+double arrival_schedule_t::rate(const piece_t& p, double t) noexcept
+{
+    double x = t - p.start;
+    switch (p.shape)
+    {
+        case shape_t::RAMP:
+            return p.a + (p.b - p.a) * x / (p.end - p.start);
+        case shape_t::SINE:
+            return p.a + p.b * std::sin(2.0 * PI * x / p.period);
+        default:
+            return p.a;
+    }
+}
+
+double arrival_schedule_t::max_rate(const piece_t& p) noexcept
+{
+    switch (p.shape)
+    {
+        case shape_t::RAMP:
+            return std::max(p.a, p.b);
+        case shape_t::SINE:
+            return p.a + p.b;
+        default:
+            return p.a;
+    }
+}
+
+double arrival_schedule_t::rate(double t) const noexcept
+{
+    auto p = piece(t);
+    return p ? rate(*p, t) : 0.0;
+}
+
+double arrival_schedule_t::expected_arrivals() const noexcept
+{
+    double n = 0;
+    for (auto& p : pieces_)
+    {
+        double d = p.end - p.start;
+        switch (p.shape)
+        {
+            case shape_t::RAMP:
+                n += (p.a + p.b) / 2.0 * d;
+                break;
+            case shape_t::SINE:
+                n += p.a * d + p.b * p.period / (2.0 * PI) * (1.0 - std::cos(2.0 * PI * d / p.period));
+                break;
+            default:
+                n += p.a * d;
+        }
+    }
+    return n;
+}
+
+double arrival_schedule_t::next_arrival(double t, double scale, std::mt19937_64& rnd) const
+{
+    // Thinning: draw candidates at the maximum rate of the current piece and
+    // keep them with probability rate / maximum rate.
+    while (true)
+    {
+        auto p = piece(t);
+        if (!p)
+            return duration();
+
+        double max = max_rate(*p) * scale;
+        if (max <= 0.0)
+        {
+            t = p->end;
+            continue;
+        }
+
+        t += -std::log(1.0 - std::generate_canonical<double, 53>(rnd)) / max;
+        if (t >= p->end)
+        {
+            // Poisson arrivals are memoryless, restart at the next piece.
+            t = p->end;
+            continue;
+        }
+
+        if (std::generate_canonical<double, 53>(rnd) * max <= rate(*p, t) * scale)
+            return t;
+    }
+}
+} // namespace PiBench
@@ -1,4 +1,8 @@
 #include "benchmark.hpp"
+#include "cpu_topology.hpp"
+#include "expiry.hpp"
+#include "jitter_probe.hpp"
+#include "request_ring.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -7,15 +11,314 @@
 #include <omp.h>
 #include <functional> // std::bind
 #include <cmath>      // std::ceil
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <regex>            // std::regex_replace
 #include <sys/utsname.h>    // uname
 #include <atomic> // std::atomic<T>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 namespace PiBench
 {
 
+/// Print events traced during a phase, including time spent in timed scopes.
+static void print_trace(std::ostream& os, const char* phase, const trace_snapshot_t& trace)
+{
+    os << "\t" << phase << ":" << std::endl;
+    for (size_t i = 0; i < TRACE_EVENTS; ++i)
+    {
+        if (trace.count[i] == 0)
+            continue;
+        os << "\t\t" << trace_event_name(i) << ": " << trace.count[i];
+        if (trace.nanos[i] > 0)
+            os << " (" << trace.nanos[i] / 1e6 << " ms)";
+        os << std::endl;
+    }
+}
+
+/// Cpus to run jitter probes on: the given list, or an idle SMT sibling of each worker.
+static std::vector<uint32_t> jitter_probe_cpus(const std::string& placement, const std::vector<uint32_t>& worker_cpus)
+{
+    if (placement != "sibling")
+        return topology::parse_cpu_list(placement);
+
+    std::vector<uint32_t> cpus;
+    for (auto w : worker_cpus)
+    {
+        for (auto c : topology::smt_siblings(w))
+        {
+            if (std::find(worker_cpus.begin(), worker_cpus.end(), c) == worker_cpus.end()
+                && std::find(cpus.begin(), cpus.end(), c) == cpus.end())
+            {
+                cpus.push_back(c);
+                break;
+            }
+        }
+    }
+
+    if (cpus.empty())
+        std::cout << "Warning: no idle SMT sibling found for jitter probes." << std::endl;
+    return cpus;
+}
+
+/// Print percentiles of sorted latencies in nanoseconds.
+static void print_percentiles(std::ostream& os, const std::string& title, const std::vector<uint64_t>& sorted)
+{
+    if (sorted.empty())
+        return;
+
+    auto observed = sorted.size();
+    os << title << " (" << observed << " operations observed):\n"
+       << "\tmin: " << sorted[0] << '\n'
+       << "\t50%: " << sorted[0.5*observed] << '\n'
+       << "\t90%: " << sorted[0.9*observed] << '\n'
+       << "\t99%: " << sorted[0.99*observed] << '\n'
+       << "\t99.9%: " << sorted[0.999*observed] << '\n'
+       << "\t99.99%: " << sorted[0.9999*observed] << '\n'
+       << "\tmax: " << sorted[observed-1] << std::endl;
+}
+
+/**
+ * @brief Draw a random delay.
+ *
+ * @param dist distribution of delays.
+ * @param mean mean delay.
+ * @param u uniform random number in [0, 1).
+ */
+static double draw_delay(delay_distribution_t dist, double mean, double u)
+{
+    switch (dist)
+    {
+        case delay_distribution_t::UNIFORM:
+            return 2.0 * mean * u;
+        case delay_distribution_t::EXPONENTIAL:
+            return -mean * std::log(1.0 - u);
+        default:
+            return mean;
+    }
+}
+
+/// Key generator of a single distribution, sized and formatted as given by the options.
+static std::unique_ptr<key_generator_t> make_key_generator(const options_t& opt, size_t N, distribution_t dist, float skew)
+{
+    bool tid_prefix = opt.bm_mode != mode_t::Operation;
+    switch (dist)
+    {
+        case distribution_t::UNIFORM:
+            return std::make_unique<uniform_key_generator_t>(N, opt.key_size, opt.num_threads, tid_prefix, opt.key_prefix);
+
+        case distribution_t::SELFSIMILAR:
+            return std::make_unique<selfsimilar_key_generator_t>(N, opt.key_size, opt.num_threads, tid_prefix, opt.key_prefix, skew);
+
+        case distribution_t::ZIPFIAN:
+            return std::make_unique<zipfian_key_generator_t>(N, opt.key_size, opt.num_threads, tid_prefix, opt.key_prefix, skew);
+
+        default:
+            std::cout << "Error: unknown distribution!" << std::endl;
+            exit(0);
+    }
+}
+
+/// Key generator of a mixture of distributions (see parse_key_mixture()), the global distribution if empty.
+static std::unique_ptr<key_generator_t> make_key_generator(const options_t& opt, size_t N, const std::string& spec)
+{
+    if (spec.empty())
+        return make_key_generator(opt, N, opt.key_distribution, opt.key_skew);
+
+    std::vector<key_component_t> mixture;
+    std::string error;
+    if (!parse_key_mixture(spec, opt.key_skew, mixture, error))
+    {
+        std::cout << "Invalid key distribution: " << error << std::endl;
+        exit(1);
+    }
+
+    if (mixture.size() == 1)
+        return make_key_generator(opt, N, mixture[0].distribution, mixture[0].skew);
+
+    std::vector<std::pair<std::unique_ptr<key_generator_t>, double>> components;
+    for (auto& c : mixture)
+        components.emplace_back(make_key_generator(opt, N, c.distribution, c.skew), c.weight);
+    return std::make_unique<mixture_key_generator_t>(N, opt.key_size, opt.num_threads, opt.bm_mode != mode_t::Operation,
+                                                     opt.key_prefix, std::move(components));
+}
+
+bool parse_key_mixture(const std::string& spec, float default_skew, std::vector<key_component_t>& mixture, std::string& error)
+{
+    std::vector<key_component_t> components;
+    std::stringstream ss(spec);
+    std::string component;
+    while (std::getline(ss, component, '+'))
+    {
+        auto at = component.find('@');
+        auto colon = component.find(':');
+        std::string name = component.substr(0, std::min(colon, at));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        key_component_t c{distribution_t::UNIFORM, default_skew, 1.0};
+        if (name == "uniform")
+            c.distribution = distribution_t::UNIFORM;
+        else if (name == "selfsimilar")
+            c.distribution = distribution_t::SELFSIMILAR;
+        else if (name == "zipfian")
+            c.distribution = distribution_t::ZIPFIAN;
+        else
+        {
+            error = "unknown distribution '" + name + "', must be one of [UNIFORM | SELFSIMILAR | ZIPFIAN]";
+            return false;
+        }
+
+        if (colon != std::string::npos && colon < at && c.distribution == distribution_t::UNIFORM)
+        {
+            error = "component '" + component + "' has a skew factor, but UNIFORM takes none";
+            return false;
+        }
+
+        try
+        {
+            // Numbers must span their whole field, so 'ZIPFIAN:0.9x' and 'UNIFORM@1@2' are rejected.
+            size_t pos = 0;
+            if (colon != std::string::npos && colon < at)
+            {
+                auto field = component.substr(colon + 1, at == std::string::npos ? std::string::npos : at - colon - 1);
+                c.skew = std::stof(field, &pos);
+                if (pos != field.size())
+                    throw std::invalid_argument(field);
+            }
+            if (at != std::string::npos)
+            {
+                auto field = component.substr(at + 1);
+                c.weight = std::stod(field, &pos);
+                if (pos != field.size())
+                    throw std::invalid_argument(field);
+            }
+        }
+        catch (const std::exception&)
+        {
+            error = "invalid number in component '" + component + "'";
+            return false;
+        }
+
+        if (!(c.weight > 0.0))
+        {
+            error = "component '" + component + "' must have a weight above 0";
+            return false;
+        }
+        if (c.distribution == distribution_t::SELFSIMILAR && (c.skew < 0.0 || c.skew > 0.5))
+        {
+            error = "component '" + component + "' must have a skew factor in the range [0, 0.5]";
+            return false;
+        }
+        if (c.distribution == distribution_t::ZIPFIAN && (c.skew < 0.0 || c.skew > 1.0))
+        {
+            error = "component '" + component + "' must have a skew factor in the range [0.0, 1.0]";
+            return false;
+        }
+        components.push_back(c);
+    }
+
+    if (components.empty())
+    {
+        error = "mixture is empty";
+        return false;
+    }
+
+    mixture = std::move(components);
+    return true;
+}
+
+/// Request passed from a client to a server and back.
+struct request_t
+{
+    operation_t op;
+
+    /// Whether the client measures the latency of this request.
+    bool sampled;
+
+    /// Result of the operation.
+    bool result;
+
+    /// Time the client submitted the request.
+    int64_t submit_ns;
+
+    /// Time a server took the request from the ring.
+    int64_t dequeue_ns;
+
+    char key[key_generator_t::KEY_MAX];
+};
+
+/// Print memory used by the process and structure statistics of the tree.
+static void print_structure(std::ostream& os, const std::string& title, tree_api* tree)
+{
+    os << title << ":" << "\n"
+       << "\tRSS: " << utils::rss_bytes() / (double)(1 << 20) << " MB" << std::endl;
+    if (!(tree->capabilities() & TREE_CAP_STATS))
+        return;
+
+    tree_stats_t stats;
+    tree->stats(stats);
+    if (stats.records > 0)
+        os << "\tRecords: " << stats.records << "\n";
+    if (stats.height > 0)
+        os << "\tHeight: " << stats.height << "\n";
+    if (stats.inner_nodes > 0)
+        os << "\tInner nodes: " << stats.inner_nodes << "\n";
+    if (stats.leaf_nodes > 0)
+        os << "\tLeaf nodes: " << stats.leaf_nodes << "\n";
+    if (stats.fill_factor > 0)
+        os << "\tFill factor: " << stats.fill_factor * 100.0 << "%\n";
+    if (stats.memory_bytes > 0)
+    {
+        os << "\tTree memory: " << stats.memory_bytes / (double)(1 << 20) << " MB";
+        if (stats.records > 0)
+            os << " (" << (double)stats.memory_bytes / stats.records << " bytes/record)";
+        os << "\n";
+    }
+    os << std::flush;
+}
+
+/// Empty polls of a ring before yielding the cpu.
+static constexpr uint32_t IDLE_SPINS = 64;
+
+/// Current time in nanoseconds.
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+/// Records in ranges aggregated by the calling thread, collected by run().
+static thread_local uint64_t thread_records_aggregated = 0;
+
+/// Records removed by range removes of the calling thread and time spent in them, collected by run().
+static thread_local uint64_t thread_records_range_removed = 0;
+static thread_local uint64_t thread_range_remove_ns = 0;
+
+/// Hint passed to operations of the calling thread (nullptr without hints) and number of them.
+static thread_local void* thread_hint = nullptr;
+static thread_local uint64_t thread_hinted_ops = 0;
+
+/// Seeks of the calling thread, those that found a record and those that found the key sought, collected by run().
+static thread_local uint64_t thread_seeks = 0;
+static thread_local uint64_t thread_seeks_found = 0;
+static thread_local uint64_t thread_seeks_exact = 0;
+
+/// Walk of the calling thread over consecutive records (--locality_run).
+struct walk_t
+{
+    /// Keys of the records of the walk, in key order.
+    std::vector<char> keys;
+
+    /// Next record of the walk and number of records.
+    uint32_t pos = 0;
+    uint32_t len = 0;
+};
+static thread_local walk_t thread_walk;
+
 void print_environment()
 {
     std::time_t now = std::time(nullptr);
@@ -80,9 +383,15 @@ void print_environment()
 benchmark_t::benchmark_t(tree_api* tree, const options_t& opt) noexcept
     : tree_(tree),
       opt_(opt),
-      op_generator_(opt.read_ratio, opt.insert_ratio, opt.update_ratio, opt.remove_ratio, opt.scan_ratio),
+      op_generator_(opt.read_ratio, opt.insert_ratio, opt.update_ratio, opt.remove_ratio, opt.scan_ratio, opt.aggregate_ratio, opt.remove_range_ratio, opt.seek_ratio),
       value_generator_(opt.value_size),
-      pcm_(nullptr)
+      pcm_(nullptr),
+      out_(&std::cout),
+      cpus_(topology::parse_cpu_list(opt.cpus)),
+      insert_id_(1),
+      aggregate_pushdown_((tree->capabilities() & TREE_CAP_AGGREGATE) && !opt.aggregate_fallback),
+      remove_range_pushdown_((tree->capabilities() & TREE_CAP_REMOVE_RANGE) && !opt.remove_range_fallback),
+      seek_pushdown_((tree->capabilities() & TREE_CAP_SEEK) && !opt.seek_fallback)
 {
     if (opt.enable_pcm)
     {
@@ -98,25 +407,44 @@ benchmark_t::benchmark_t(tree_api* tree, const options_t& opt) noexcept
         }
     }
 
-    size_t key_space_sz = opt_.num_records + (opt_.num_ops * opt_.insert_ratio);
-    switch (opt_.key_distribution)
+    if (opt_.duplicates > 0)
     {
-        case distribution_t::UNIFORM:
-            key_generator_ = std::make_unique<uniform_key_generator_t>(key_space_sz, opt_.key_size, opt_.num_threads, opt_.bm_mode == mode_t::Operation ? false : true, opt_.key_prefix);
-            break;
-
-        case distribution_t::SELFSIMILAR:
-            key_generator_ = std::make_unique<selfsimilar_key_generator_t>(key_space_sz, opt_.key_size, opt_.num_threads, opt_.bm_mode == mode_t::Operation ? false : true, opt_.key_prefix, opt_.key_skew);
-            break;
-
-        case distribution_t::ZIPFIAN:
-            key_generator_ = std::make_unique<zipfian_key_generator_t>(key_space_sz, opt_.key_size, opt_.num_threads, opt_.bm_mode == mode_t::Operation ? false : true, opt_.key_prefix, opt_.key_skew);
-            break;
+        // P(k records) is proportional to 1 / k^skew.
+        double sum = 0;
+        for (uint32_t k = 1; k <= opt_.duplicates; ++k)
+        {
+            sum += 1.0 / std::pow(k, opt_.duplicate_skew);
+            duplicate_cdf_.push_back(sum);
+        }
+        for (auto& c : duplicate_cdf_)
+            c /= sum;
+    }
 
-        default:
-            std::cout << "Error: unknown distribution!" << std::endl;
-            exit(0);
+    size_t key_space_sz = opt_.num_records + (opt_.num_ops * opt_.insert_ratio);
+    if (opt_.read_distribution.empty() && opt_.update_distribution.empty() && opt_.remove_distribution.empty() && opt_.scan_distribution.empty())
+    {
+        key_generator_ = make_key_generator(opt_, key_space_sz, opt_.key_distribution, opt_.key_skew);
     }
+    else
+    {
+        // Inserts draw ids in sequence, their generator is only used for false accesses.
+        std::vector<std::unique_ptr<key_generator_t>> generators;
+        generators.push_back(make_key_generator(opt_, key_space_sz, opt_.read_distribution));
+        generators.push_back(make_key_generator(opt_, key_space_sz, ""));
+        generators.push_back(make_key_generator(opt_, key_space_sz, opt_.update_distribution));
+        generators.push_back(make_key_generator(opt_, key_space_sz, opt_.remove_distribution));
+
+        // Scans, aggregates, range removes and seeks.
+        for (size_t i = static_cast<size_t>(operation_t::SCAN); i <= static_cast<size_t>(operation_t::SEEK); ++i)
+            generators.push_back(make_key_generator(opt_, key_space_sz, opt_.scan_distribution));
+        key_generator_ = std::make_unique<operation_key_generator_t>(key_space_sz, opt_.key_size, opt_.num_threads, opt_.bm_mode != mode_t::Operation,
+                                                                     opt_.key_prefix, std::move(generators));
+    }
+
+    // Keys of 8 Bytes without prefix or tid (operation mode) are the native-endian bytes of an integer.
+    u64_ = (tree->capabilities() & TREE_CAP_U64) && opt_.typed_keys && opt_.bm_mode == mode_t::Operation
+           && opt_.key_size == sizeof(uint64_t) && opt_.key_prefix.empty() && opt_.value_size == sizeof(uint64_t)
+           && opt_.duplicates == 0 && opt_.locality_run == 0;
 }
 
 benchmark_t::~benchmark_t()
@@ -125,6 +453,27 @@ benchmark_t::~benchmark_t()
         pcm_->cleanup();
 }
 
+void benchmark_t::set_calibration(const calibration_t& calibration) noexcept
+{
+    calibration_ = calibration;
+    has_calibration_ = true;
+}
+
+void benchmark_t::set_output(std::ostream& os) noexcept
+{
+    out_ = &os;
+}
+
+void benchmark_t::set_trace_shared(bool shared) noexcept
+{
+    trace_shared_ = shared;
+}
+
+void benchmark_t::skip_insert_ids(uint64_t count) noexcept
+{
+    insert_id_ += count;
+}
+
 void benchmark_t::load() noexcept
 {
     uint64_t insert_per_thread = opt_.num_records / opt_.num_threads;
@@ -133,7 +482,7 @@ void benchmark_t::load() noexcept
     {
         if(opt_.bm_mode == mode_t::Operation)
         {
-            key_generator_->current_id_ = opt_.num_records + 1;
+            insert_id_ = opt_.num_records + 1;
         }
         else if(opt_.bm_mode == mode_t::Time)
         {
@@ -145,6 +494,9 @@ void benchmark_t::load() noexcept
                     key_generator_->thread_stat[i] = opt_.num_records % opt_.num_threads + insert_per_thread + 1;
             }
         }
+
+        if (opt_.aging_ops > 0)
+            age();
         return;
     }
 
@@ -159,13 +511,40 @@ void benchmark_t::load() noexcept
         }
     };
 
+    auto trace_before = trace_snapshot();
+
+    // Ids are kept per thread, start from the first id even if this thread loaded another tree before.
+    key_generator_->current_id_ = insert_id_;
+
+    // Records inserted for keys with duplicates (multimap workload).
+    uint64_t duplicate_records = 0;
+
     stopwatch_t sw;
     sw.start();
     for (uint64_t i = 0; i < opt_.num_records; ++i)
     {
+        if (u64_)
+        {
+            uint64_t value;
+            memcpy(&value, value_generator_.next(), sizeof(value));
+            auto r = tree_->insert_u64(key_generator_->next_u64(false, true), value);
+            assert(r);
+            continue;
+        }
+
         // Generate key in sequence
         auto key_ptr = opt_.bm_mode == mode_t::Operation ? key_generator_->next(false, true) : key_generator_->next(tid_generate(i,opt_.num_threads), false, true);
 
+        if (opt_.duplicates > 0)
+        {
+            auto id = key_generator_->last_id_;
+            auto count = duplicates_of(id);
+            for (uint32_t j = 0; j < count; ++j)
+                tree_->insert_dup(key_ptr, key_generator_->size(), duplicate_value(id, j), opt_.value_size);
+            duplicate_records += count;
+            continue;
+        }
+
         // Generate random value
         auto value_ptr = value_generator_.next();
 
@@ -174,13 +553,386 @@ void benchmark_t::load() noexcept
     }
 
     auto elapsed = sw.elapsed<std::chrono::milliseconds>();
+    load_trace_ = trace_snapshot() - trace_before;
+    insert_id_ = key_generator_->current_id_;
 
-    std::cout << "Overview:"
+    *out_ << "Overview:"
               << "\n"
               << "\tLoad time: " << elapsed << " milliseconds" << std::endl;
+    if (u64_)
+        *out_ << "\tInteger keys: native entry points" << std::endl;
+    if (opt_.duplicates > 0)
+        *out_ << "\tRecords with duplicate keys: " << duplicate_records << " ("
+              << (double)duplicate_records / opt_.num_records << " per key)" << std::endl;
+
+    if (opt_.aging_ops > 0)
+        age();
+}
+
+void benchmark_t::load_growth() noexcept
+{
+    const size_t key_size = key_generator_->size();
+    const uint64_t first_id = insert_id_;
+    const bool has_stats = tree_->capabilities() & TREE_CAP_STATS;
+    prepare_probes();
+    const uint64_t base_rss = utils::rss_bytes();
+
+    struct checkpoint_t
+    {
+        uint64_t records;
+        double insert_throughput;
+        double lookup_throughput;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t rss;
+        uint64_t tree_bytes;
+    };
+    std::vector<checkpoint_t> curve;
+
+    auto trace_before = trace_snapshot();
+    key_generator_->current_id_ = insert_id_;
+
+    float load_ms = 0;
+    uint64_t loaded = 0;
+    uint64_t target = std::min(opt_.growth_start, opt_.num_records);
+    while (true)
+    {
+        checkpoint_t c{};
+        c.records = target;
+
+        stopwatch_t sw;
+        sw.start();
+        uint64_t inserts = target - loaded;
+        for (; loaded < target; ++loaded)
+        {
+            auto key_ptr = key_generator_->next(false, true);
+            auto r = tree_->insert(key_ptr, key_size, value_generator_.next(), opt_.value_size);
+            assert(r);
+        }
+        auto insert_ms = sw.elapsed<std::chrono::milliseconds>();
+        load_ms += insert_ms;
+        c.insert_throughput = insert_ms > 0 ? inserts / (insert_ms / 1000) : 0;
+
+        auto probe = probe_lookups(first_id, target);
+        c.lookup_throughput = probe.throughput;
+        c.p50 = probe.p50;
+        c.p99 = probe.p99;
+        c.p999 = probe.p999;
+
+        c.rss = utils::rss_bytes();
+        if (has_stats)
+        {
+            tree_stats_t stats;
+            tree_->stats(stats);
+            c.tree_bytes = stats.memory_bytes;
+        }
+        curve.push_back(c);
+
+        if (target == opt_.num_records)
+            break;
+        target = std::min(target * 2, opt_.num_records);
+    }
+
+    load_trace_ = trace_snapshot() - trace_before;
+    insert_id_ = key_generator_->current_id_;
+
+    *out_ << "Overview:"
+              << "\n"
+              << "\tLoad time: " << load_ms << " milliseconds" << std::endl;
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "Growth curve (" << opt_.probe_ops << " lookups per checkpoint):" << std::endl;
+    *out_ << "\trecords\tinsert ops/s\tlookup ops/s\t50% ns\t99% ns\t99.9% ns\tRSS MB\tRSS B/record"
+          << (has_stats ? "\ttree B/record" : "") << std::endl;
+    for (auto& c : curve)
+    {
+        // RSS growth since the load started is attributed to the records.
+        uint64_t rss_growth = c.rss > base_rss ? c.rss - base_rss : 0;
+        *out_ << "\t" << c.records
+              << "\t" << c.insert_throughput
+              << "\t" << c.lookup_throughput
+              << "\t" << c.p50
+              << "\t" << c.p99
+              << "\t" << c.p999
+              << "\t" << c.rss / (double)(1 << 20)
+              << "\t" << (double)rss_growth / c.records;
+        if (has_stats)
+            *out_ << "\t" << (double)c.tree_bytes / c.records;
+        *out_ << std::endl;
+    }
+
+    if (opt_.aging_ops > 0)
+        age();
+}
+
+void benchmark_t::run_capacity() noexcept
+{
+    const size_t key_size = key_generator_->size();
+    const uint64_t first_id = insert_id_;
+    const bool tree_source = opt_.memory_budget_source == "tree";
+
+    // Probe buffers exist before the base, so only the tree grows the RSS.
+    prepare_probes();
+    const uint64_t base_rss = utils::rss_bytes();
+
+    if (tree_source && !(tree_->capabilities() & TREE_CAP_STATS))
+    {
+        std::cout << "Tree does not report its memory, use the rss budget source." << std::endl;
+        exit(1);
+    }
+
+    auto memory = [&]() -> uint64_t {
+        if (!tree_source)
+        {
+            auto rss = utils::rss_bytes();
+            return rss > base_rss ? rss - base_rss : 0;
+        }
+        tree_stats_t stats;
+        tree_->stats(stats);
+        return stats.memory_bytes;
+    };
+
+    struct step_t
+    {
+        uint64_t records;
+        uint64_t memory;
+        double insert_throughput;
+        double lookup_throughput;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+    };
+    std::vector<step_t> steps;
+
+    key_generator_->current_id_ = insert_id_;
+
+    // Memory is checked every 1% of the records loaded so far, which bounds
+    // the overshoot of the budget.
+    static constexpr uint64_t MIN_CHECK_INTERVAL = 10000;
+    uint64_t loaded = 0;
+    uint64_t capacity = 0;
+    uint64_t capacity_memory = 0;
+    uint64_t step_start = 0;
+    uint32_t tenths = 1;
+    bool insert_failed = false;
+
+    stopwatch_t fill_sw;
+    fill_sw.start();
+    stopwatch_t step_sw;
+    step_sw.start();
+    float step_ms = 0;
+    while (true)
+    {
+        uint64_t interval = std::max(MIN_CHECK_INTERVAL, loaded / 100);
+        for (uint64_t i = 0; i < interval; ++i)
+        {
+            auto key_ptr = key_generator_->next(false, true);
+            if (!tree_->insert(key_ptr, key_size, value_generator_.next(), opt_.value_size))
+            {
+                insert_failed = true;
+                break;
+            }
+            ++loaded;
+        }
+        step_ms += step_sw.elapsed<std::chrono::milliseconds>();
+
+        auto used = memory();
+        bool full = insert_failed || used > opt_.memory_budget;
+        if (!full)
+        {
+            capacity = loaded;
+            capacity_memory = used;
+        }
+
+        if (full || used * 10 >= opt_.memory_budget * tenths)
+        {
+            step_t step;
+            step.records = capacity;
+            step.memory = capacity_memory;
+            step.insert_throughput = step_ms > 0 ? (loaded - step_start) / (step_ms / 1000) : 0;
+            auto probe = probe_lookups(first_id, capacity);
+            step.lookup_throughput = probe.throughput;
+            step.p50 = probe.p50;
+            step.p99 = probe.p99;
+            step.p999 = probe.p999;
+            steps.push_back(std::move(step));
+
+            step_start = loaded;
+            step_ms = 0;
+            while (used * 10 >= opt_.memory_budget * tenths)
+                ++tenths;
+        }
+        if (full)
+            break;
+        step_sw.start();
+    }
+    auto fill_ms = fill_sw.elapsed<std::chrono::milliseconds>();
+    insert_id_ = key_generator_->current_id_;
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "Capacity (" << opt_.memory_budget / (double)(1 << 20) << " MB of "
+          << (tree_source ? "tree memory" : "RSS growth") << "):" << "\n"
+          << "\tStopped by: " << (insert_failed ? "failed insert" : "memory budget") << "\n"
+          << "\tRecords at capacity: " << capacity << "\n"
+          << "\tMemory at capacity: " << capacity_memory / (double)(1 << 20) << " MB ("
+          << (capacity > 0 ? (double)capacity_memory / capacity : 0.0) << " bytes/record)" << "\n"
+          << "\tFill time: " << fill_ms << " milliseconds" << std::endl;
+
+    *out_ << "Capacity fill (" << opt_.probe_ops << " lookups per step):" << std::endl;
+    *out_ << "\tfill\trecords\tMB\tB/record\tinsert ops/s\tlookup ops/s\t50% ns\t99% ns\t99.9% ns" << std::endl;
+    for (auto& step : steps)
+    {
+        *out_ << "\t" << 100.0 * step.memory / opt_.memory_budget << "%"
+              << "\t" << step.records
+              << "\t" << step.memory / (double)(1 << 20)
+              << "\t" << (step.records > 0 ? (double)step.memory / step.records : 0.0)
+              << "\t" << step.insert_throughput
+              << "\t" << step.lookup_throughput
+              << "\t" << step.p50
+              << "\t" << step.p99
+              << "\t" << step.p999 << std::endl;
+    }
+}
+
+run_result_t benchmark_t::probe_lookups(uint64_t first_id, uint64_t records) noexcept
+{
+    if (records == 0)
+        return run_result_t{};
+
+    const size_t key_size = key_generator_->size();
+    const uint64_t probe_per_thread = opt_.probe_ops / opt_.num_threads;
+    prepare_probes();
+    auto& latencies = probe_latencies_;
+
+    stopwatch_t sw;
+    sw.start();
+    #pragma omp parallel num_threads(opt_.num_threads)
+    {
+        auto tid = omp_get_thread_num();
+
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[tid % cpus_.size()]);
+
+        // Lookups only draw records already loaded.
+        std::mt19937_64 rnd(opt_.rnd_seed * (tid + 1) + records);
+        std::uniform_int_distribution<uint64_t> id_dist(first_id, first_id + records - 1);
+        char key[key_generator_t::KEY_MAX];
+        static thread_local char value_out[value_generator_t::VALUE_MAX];
+
+        auto& lat = latencies[tid];
+        lat.clear();
+        for (uint64_t i = 0; i < probe_per_thread; ++i)
+        {
+            key_generator_->key_of(id_dist(rnd), key);
+            auto start = now_ns();
+            tree_->find(key, key_size, value_out);
+            lat.push_back(now_ns() - start);
+        }
+    }
+
+    run_result_t result;
+    result.elapsed_ms = sw.elapsed<std::chrono::milliseconds>();
+    auto& sorted = probe_sorted_;
+    sorted.clear();
+    for (auto& lat : latencies)
+        sorted.insert(sorted.end(), lat.begin(), lat.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    auto observed = sorted.size();
+    result.operations = observed;
+    result.throughput = result.elapsed_ms > 0 ? observed / (result.elapsed_ms / 1000) : 0;
+    if (observed > 0)
+    {
+        result.p50 = sorted[0.5*observed];
+        result.p99 = sorted[0.99*observed];
+        result.p999 = sorted[0.999*observed];
+    }
+    return result;
+}
+
+void benchmark_t::prepare_probes() noexcept
+{
+    if (probe_latencies_.size() == opt_.num_threads)
+        return;
+
+    // Buffers are filled once, so their pages are resident before memory is measured.
+    const uint64_t probe_per_thread = opt_.probe_ops / opt_.num_threads;
+    probe_latencies_.resize(opt_.num_threads);
+    for (auto& lat : probe_latencies_)
+    {
+        lat.resize(probe_per_thread);
+        lat.clear();
+    }
+    probe_sorted_.resize(probe_per_thread * opt_.num_threads);
+    probe_sorted_.clear();
+}
+
+void benchmark_t::age() noexcept
+{
+    print_structure(*out_, "Structure (loaded)", tree_);
+
+    const size_t key_size = key_generator_->size();
+    const uint64_t first_id = insert_id_ - opt_.num_records;
+
+    std::mt19937_64 rnd(opt_.rnd_seed);
+    std::uniform_int_distribution<uint64_t> id_dist(first_id, insert_id_ - 1);
+    std::uniform_real_distribution<float> op_dist(0.0, 1.0);
+
+    std::vector<char> keys(static_cast<size_t>(opt_.aging_batch) * key_size);
+    std::vector<uint32_t> order;
+    uint64_t reinserted = 0;
+    uint64_t updated = 0;
+    uint64_t failed = 0;
+
+    stopwatch_t sw;
+    sw.start();
+    for (uint64_t done = 0; done < opt_.aging_ops;)
+    {
+        uint64_t batch = std::min<uint64_t>(opt_.aging_batch, opt_.aging_ops - done);
+        uint32_t removed = 0;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            char* key = &keys[removed * key_size];
+            key_generator_->key_of(id_dist(rnd), key);
+            if (op_dist(rnd) < opt_.aging_update_ratio)
+            {
+                if (tree_->update(key, key_size, value_generator_.next(), opt_.value_size))
+                    ++updated;
+                else
+                    ++failed;
+            }
+            else if (tree_->remove(key, key_size))
+                ++removed;
+            else
+                ++failed; // Drawn twice in this round.
+        }
+
+        // Reinsert in another order, so freed space is reused by other keys.
+        order.resize(removed);
+        for (uint32_t i = 0; i < removed; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rnd);
+        for (auto i : order)
+        {
+            if (tree_->insert(&keys[i * key_size], key_size, value_generator_.next(), opt_.value_size))
+                ++reinserted;
+            else
+                ++failed;
+        }
+        done += batch;
+    }
+    auto elapsed = sw.elapsed<std::chrono::milliseconds>();
+
+    *out_ << "Aging:" << "\n"
+          << "\tAging time: " << elapsed << " milliseconds" << "\n"
+          << "\tRemoved and reinserted: " << reinserted << "\n"
+          << "\tUpdated: " << updated << "\n"
+          << "\tFailed: " << failed << std::endl;
+    print_structure(*out_, "Structure (aged)", tree_);
 }
 
-void benchmark_t::run() noexcept
+run_result_t benchmark_t::run() noexcept
 {
     std::vector<stats_t> global_stats;
 
@@ -191,6 +943,10 @@ void benchmark_t::run() noexcept
                                                         static_cast<uint64_t>((opt_.time * 1000 / opt_.sampling_ms) + 10)); // Avoid overhead of allocation and page fault
     global_stats.resize(0);
 
+    // Trace counters at the end of each sampling window.
+    std::vector<trace_snapshot_t> trace_samples;
+    trace_samples.reserve(global_stats.capacity());
+
     if(opt_.bm_mode == mode_t::Operation)
     {
         for(auto& lc : local_stats)
@@ -211,7 +967,7 @@ void benchmark_t::run() noexcept
 
 
     static thread_local char value_out[value_generator_t::VALUE_MAX];
-    char* values_out;
+    char* values_out = nullptr;
 
     // Control variable of monitor thread
     std::atomic<bool> finished(false);
@@ -228,9 +984,30 @@ void benchmark_t::run() noexcept
 
     std::discrete_distribution<bool> dis {opt_.negative_access_rate, 1-opt_.negative_access_rate};
 
-    // Start Benchmark
-    // Operation based mode
-    if(opt_.bm_mode == mode_t::Operation)
+    auto trace_before = trace_snapshot();
+
+    // Probes are started by the workers, once they know which cpus they run on.
+    std::unique_ptr<jitter_probe_t> jitter;
+    std::vector<uint32_t> worker_cpus(opt_.num_threads);
+    if (!opt_.jitter_probe.empty())
+        jitter = std::make_unique<jitter_probe_t>(opt_.jitter_threshold_ns);
+
+    // Origin of the jitter timeline, sampling windows start at the same time.
+    auto run_start = std::chrono::high_resolution_clock::now();
+
+    // Removes records inserted with a time-to-live once they expire.
+    std::unique_ptr<expiry_t> expiry;
+
+    // Memory released by range removes, if the tree reports it and no long
+    // scans use the tree next to the workers.
+    const bool range_remove_memory = opt_.remove_range_ratio > 0 && (tree_->capabilities() & TREE_CAP_STATS) && !long_scans_running_;
+    tree_stats_t stats_before;
+    if (range_remove_memory)
+        tree_->stats(stats_before);
+
+    // Start Benchmark
+    // Operation based mode
+    if(opt_.bm_mode == mode_t::Operation)
     {
 
 
@@ -238,7 +1015,14 @@ void benchmark_t::run() noexcept
         uint64_t inserts_per_thread = 10 + (opt_.num_ops * opt_.insert_ratio) / opt_.num_threads;
 
         // Current id after load
-        uint64_t current_id = key_generator_->current_id_;
+        uint64_t current_id = insert_id_;
+
+        if (opt_.ttl_ms > 0)
+        {
+            expiry = std::make_unique<expiry_t>(tree_, *key_generator_, opt_.num_threads,
+                                                current_id + inserts_per_thread * opt_.num_threads);
+            expiry->start();
+        }
 
         omp_set_nested(true);
         #pragma omp parallel sections num_threads(2)
@@ -255,6 +1039,7 @@ void benchmark_t::run() noexcept
                                                             return sum + curr.operation_count;
                                                         });
                     global_stats.push_back(std::move(s));
+                    trace_samples.push_back(trace_snapshot());
                 }
             }
 
@@ -265,6 +1050,9 @@ void benchmark_t::run() noexcept
                 {
                     auto tid = omp_get_thread_num();
 
+                    if (!cpus_.empty())
+                        topology::pin_thread(cpus_[tid % cpus_.size()]);
+
                     // Initialize random seed for each thread
                     key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
 
@@ -273,6 +1061,18 @@ void benchmark_t::run() noexcept
                     key_generator_->current_id_ = current_id + (inserts_per_thread * tid);
 
                     auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
+                    std::mt19937_64 ttl_rnd(opt_.rnd_seed * (tid + 1) + 1);
+                    std::mt19937_64 seek_rnd(opt_.rnd_seed * (tid + 1) + 2);
+                    std::bernoulli_distribution seek_gap(opt_.seek_gap_ratio);
+                    const double ttl_ns = opt_.ttl_ms * 1e6;
+
+                    if (jitter)
+                    {
+                        worker_cpus[tid] = topology::current_cpu();
+                        #pragma omp barrier
+                        #pragma omp single
+                        jitter->start(jitter_probe_cpus(opt_.jitter_probe, worker_cpus));
+                    }
 
                     #pragma omp barrier
 
@@ -281,14 +1081,35 @@ void benchmark_t::run() noexcept
                         stopwatch.start();
                     }
 
+                    thread_records_aggregated = 0;
+                    thread_records_range_removed = 0;
+                    thread_range_remove_ns = 0;
+                    thread_seeks = thread_seeks_found = thread_seeks_exact = 0;
+                    thread_hint = use_hints_ ? tree_->hint_create() : nullptr;
+                    thread_hinted_ops = 0;
+                    thread_walk.pos = thread_walk.len = 0;
+
                     #pragma omp for schedule(static)
                     for (uint64_t i = 0; i < opt_.num_ops; ++i)
                     {
                         // Generate random operation
                         auto op = op_generator_.next();
+                        operation_key_generator_t::select(op);
+
+                        // Point operations skip key materialization on the integer fast path.
+                        bool typed = u64_ && !thread_hint && op <= operation_t::REMOVE;
 
                         // Generate random scrambled key
-                        auto key_ptr = key_generator_->next( false, op == operation_t::INSERT ? true : false);
+                        const char* key_ptr = nullptr;
+                        uint64_t key_u64 = 0;
+                        if(typed)
+                            key_u64 = key_generator_->next_u64(false, op == operation_t::INSERT);
+                        else
+                            key_ptr = key_generator_->next( false, op == operation_t::INSERT ? true : false);
+                        if(opt_.locality_run > 0 && (op == operation_t::READ || op == operation_t::UPDATE))
+                            key_ptr = walk_key(key_ptr);
+                        else if(op == operation_t::SEEK && seek_gap(seek_rnd))
+                            key_ptr = key_generator_->next(true, false);
 
                         auto measure_latency = random_bool();
                         if(measure_latency)
@@ -296,34 +1117,67 @@ void benchmark_t::run() noexcept
                             local_stats[tid].times.push_back(std::chrono::high_resolution_clock::now());
                         }
 
-                        if(!run_op(op,key_ptr,value_out,values_out))
-                            ++local_stats[tid].operation_count_F;
+                        bool r = typed ? run_op_u64(op, key_u64) : run_op(op,key_ptr,value_out,values_out);
 
                         if(measure_latency)
                         {
                             local_stats[tid].times.push_back(std::chrono::high_resolution_clock::now());
                         }
+
+                        if(expiry)
+                        {
+                            if(r && op == operation_t::INSERT)
+                                expiry->add(tid, key_generator_->last_id_, draw_delay(opt_.ttl_distribution, ttl_ns, std::generate_canonical<double, 53>(ttl_rnd)));
+                            else if(!r && op != operation_t::INSERT && expiry->expired(key_generator_->last_id_))
+                            {
+                                // Expected miss, the record expired.
+                                ++local_stats[tid].operation_count_expired;
+                                r = true;
+                            }
+                        }
+
+                        if(!r)
+                            ++local_stats[tid].operation_count_F;
                         ++local_stats[tid].operation_count;
                     }
+                    local_stats[tid].records_aggregated = thread_records_aggregated;
+                    local_stats[tid].records_range_removed = thread_records_range_removed;
+                    local_stats[tid].range_remove_ns = thread_range_remove_ns;
+                    local_stats[tid].seeks = thread_seeks;
+                    local_stats[tid].seeks_found = thread_seeks_found;
+                    local_stats[tid].seeks_exact = thread_seeks_exact;
+                    if(thread_hint)
+                    {
+                        local_stats[tid].hinted_ops = thread_hinted_ops;
+                        local_stats[tid].hint_hits = tree_->hint_hits(thread_hint);
+                        tree_->hint_destroy(thread_hint);
+                        thread_hint = nullptr;
+                    }
 
                     // Get elapsed time and signal monitor thread to finish.
                     #pragma omp single nowait
                     {
                         elapsed = stopwatch.elapsed<std::chrono::milliseconds>();
                         finished.store(true);
+
+                        // Records expiring while the monitor finishes its window are not part of the run.
+                        if (expiry)
+                            expiry->stop();
                     }
                 }
             }
         }
         omp_set_nested(false);
 
+        // Next run inserts after the ids reserved by this one.
+        insert_id_ = current_id + inserts_per_thread * opt_.num_threads;
     }
     // Time based mode
     else
     {
 
         omp_set_nested(true);
-        #pragma omp parallel sections num_threads(2) default(none) shared(finished,local_stats,global_stats,elapsed,values_out,std::cout,stopwatch,dis)
+        #pragma omp parallel sections num_threads(2) default(none) shared(finished,local_stats,global_stats,trace_samples,elapsed,values_out,stopwatch,dis,jitter,worker_cpus)
         {
             #pragma omp section // Monitor & timer thread
             {
@@ -337,6 +1191,7 @@ void benchmark_t::run() noexcept
                                                             return sum + curr.operation_count;
                                                         });
                     global_stats.push_back(std::move(s));
+                    trace_samples.push_back(trace_snapshot());
                     if(stopwatch.elapsed<std::chrono::seconds>() > opt_.time)
                     {
                         finished.store(true);
@@ -352,15 +1207,27 @@ void benchmark_t::run() noexcept
                 {
                     auto tid = omp_get_thread_num();
 
+                    if (!cpus_.empty())
+                        topology::pin_thread(cpus_[tid % cpus_.size()]);
+
                     key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
 
                     std::default_random_engine engine(time(0) * (tid+1));
+                    std::bernoulli_distribution seek_gap(opt_.seek_gap_ratio);
 
                     // How many inserts are within this thread ID's range
                     key_generator_->current_id_ = key_generator_->thread_stat[tid];
 
                     auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
 
+                    if (jitter)
+                    {
+                        worker_cpus[tid] = topology::current_cpu();
+                        #pragma omp barrier
+                        #pragma omp single
+                        jitter->start(jitter_probe_cpus(opt_.jitter_probe, worker_cpus));
+                    }
+
                     #pragma omp barrier
 
                     #pragma single nowait
@@ -368,11 +1235,17 @@ void benchmark_t::run() noexcept
                         stopwatch.start();
                     }
 
+                    thread_records_aggregated = 0;
+                    thread_records_range_removed = 0;
+                    thread_range_remove_ns = 0;
+                    thread_seeks = thread_seeks_found = thread_seeks_exact = 0;
+
                     while(!finished.load())
                     {
 
                         // Generate random operation
                         auto op = op_generator_.next();
+                        operation_key_generator_t::select(op);
 
                         const char* key_ptr;
 
@@ -388,6 +1261,8 @@ void benchmark_t::run() noexcept
                             else
                                 key_ptr = dis(engine) ? key_generator_->next(tid,false,false) : key_generator_->next(tid,true, false);
                         }
+                        else if(op == operation_t::SEEK)
+                            key_ptr = key_generator_->next(tid, seek_gap(engine), false);
                         else
                             key_ptr = key_generator_->next(tid, false, false);
 
@@ -407,6 +1282,12 @@ void benchmark_t::run() noexcept
                         }
                         ++local_stats[tid].operation_count;
                     }
+                    local_stats[tid].records_aggregated = thread_records_aggregated;
+                    local_stats[tid].records_range_removed = thread_records_range_removed;
+                    local_stats[tid].range_remove_ns = thread_range_remove_ns;
+                    local_stats[tid].seeks = thread_seeks;
+                    local_stats[tid].seeks_found = thread_seeks_found;
+                    local_stats[tid].seeks_exact = thread_seeks_exact;
                 }
 
             }
@@ -414,6 +1295,15 @@ void benchmark_t::run() noexcept
         omp_set_nested(false);
     }
 
+    if (jitter)
+        jitter->stop();
+    auto run_end = std::chrono::high_resolution_clock::now();
+
+    // Workers have joined and the expiry thread has stopped.
+    tree_stats_t stats_after;
+    if (range_remove_memory)
+        tree_->stats(stats_after);
+
     std::unique_ptr<SystemCounterState> after_sstate;
     if (opt_.enable_pcm)
     {
@@ -421,34 +1311,117 @@ void benchmark_t::run() noexcept
         *after_sstate = getSystemCounterState();
     }
 
-    std::cout << std::fixed << std::setprecision(4);
-    std::cout << "\tRun time: " << elapsed << " milliseconds" << std::endl;
+    auto run_trace = trace_snapshot() - trace_before;
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "\tRun time: " << elapsed << " milliseconds" << std::endl;
 
     // False operation number
     uint64_t op_num_f = 0;
     for(auto &lc: local_stats)
         op_num_f+=lc.operation_count_F;
 
-    if(opt_.bm_mode == mode_t::Operation)
+    // Number of operations done while benchmarking
+    uint64_t op_num = 0;
+    for(auto &lc: local_stats)
+        op_num += lc.operation_count;
+    double throughput = op_num / ((double)elapsed / 1000);
+
+    *out_ << "\tThroughput: " << throughput << " ops/s" << std::endl;
+    *out_ << "\tFalse access rate: " << ((float)op_num_f * 100.0 / op_num) << "%" <<std::endl;
+
+    if (expiry)
     {
-        std::cout << "\tThroughput: " << opt_.num_ops / ((float)elapsed / 1000)
-                  << " ops/s" << std::endl;
-        std::cout << "\tFalse access rate: " << (float)op_num_f * 100.0 / opt_.num_ops << "%" <<std::endl;
+        uint64_t op_num_expired = 0;
+        for(auto &lc: local_stats)
+            op_num_expired += lc.operation_count_expired;
+
+        *out_ << "TTL expiry (" << opt_.ttl_distribution << ", mean " << opt_.ttl_ms << " ms):" << "\n"
+              << "\tInserted with TTL: " << expiry->registered() << "\n"
+              << "\tExpired: " << expiry->removed() + expiry->failed() << " (" << expiry->failed() << " failed removes)" << "\n"
+              << "\tPending: " << expiry->pending() << "\n"
+              << "\tExpected misses: " << op_num_expired << " (" << ((float)op_num_expired * 100.0 / op_num) << "%)" << "\n"
+              << "\tRegistration stalls: " << expiry->stalls() << std::endl;
+        print_percentiles(*out_, "Expiry lag", expiry->lag_ns());
     }
-    else
+
+    if (use_hints_)
+    {
+        uint64_t hinted_ops = 0;
+        uint64_t hint_hits = 0;
+        for(auto &lc: local_stats)
+        {
+            hinted_ops += lc.hinted_ops;
+            hint_hits += lc.hint_hits;
+        }
+
+        *out_ << "Hints:" << "\n"
+              << "\tHinted operations: " << hinted_ops << "\n"
+              << "\tHint hit rate: " << (hinted_ops > 0 ? (float)hint_hits * 100.0 / hinted_ops : 0.0) << "%" << std::endl;
+    }
+
+    if (opt_.seek_ratio > 0)
+    {
+        uint64_t seeks = 0;
+        uint64_t found = 0;
+        uint64_t exact = 0;
+        for(auto &lc: local_stats)
+        {
+            seeks += lc.seeks;
+            found += lc.seeks_found;
+            exact += lc.seeks_exact;
+        }
+
+        *out_ << "Seeks (" << opt_.seek_type << ", " << (seek_pushdown_ ? "pushed down" : "scan fallback") << "):" << "\n"
+              << "\tSeeks: " << seeks << "\n"
+              << "\tRecord found: " << (seeks > 0 ? (float)found * 100.0 / seeks : 0.0) << "%" << "\n"
+              << "\tKey found: " << (seeks > 0 ? (float)exact * 100.0 / seeks : 0.0) << "%" << std::endl;
+    }
+
+    if (opt_.aggregate_ratio > 0)
+    {
+        uint64_t records_aggregated = 0;
+        for(auto &lc: local_stats)
+            records_aggregated += lc.records_aggregated;
+
+        *out_ << "Range aggregates (" << (aggregate_pushdown_ ? "pushed down" : "scan fallback") << ", "
+              << opt_.aggregate_size << " records):" << "\n"
+              << "\tRecords aggregated: " << records_aggregated << "\n"
+              << "\tRecords aggregated per second: " << records_aggregated / ((double)elapsed / 1000) << std::endl;
+    }
+
+    if (opt_.remove_range_ratio > 0)
     {
-        // Number of operations done while benchmarking
-        uint64_t op_num = 0;
+        uint64_t records_removed = 0;
+        uint64_t remove_ns = 0;
         for(auto &lc: local_stats)
-            op_num += lc.operation_count;
-        std::cout << "\tThroughput: " << op_num / ((float)elapsed / 1000)
-                  << " ops/s" << std::endl;
-        std::cout << "\tFalse access rate: " << ((float)op_num_f * 100.0 / op_num) << "%" <<std::endl;
+        {
+            records_removed += lc.records_range_removed;
+            remove_ns += lc.range_remove_ns;
+        }
+
+        *out_ << "Range removes (" << (remove_range_pushdown_ ? "pushed down" : "scan and remove") << ", "
+              << opt_.remove_range_size << " records):" << "\n"
+              << "\tRecords removed: " << records_removed << "\n"
+              << "\tTime per removed record: " << (records_removed > 0 ? (double)remove_ns / records_removed : 0.0) << " ns" << std::endl;
+
+        if (range_remove_memory)
+        {
+            // Trees reclaiming memory lazily release less than they used for
+            // the records, inserts of the run also add memory.
+            int64_t released = static_cast<int64_t>(stats_before.memory_bytes) - static_cast<int64_t>(stats_after.memory_bytes);
+            *out_ << "\tTree memory: " << stats_before.memory_bytes / (double)(1 << 20) << " MB before, "
+                  << stats_after.memory_bytes / (double)(1 << 20) << " MB after" << "\n"
+                  << "\tMemory released per removed record: " << (records_removed > 0 ? (double)released / records_removed : 0.0) << " bytes";
+            if (opt_.insert_ratio > 0)
+                *out_ << " (distorted by inserts of the run)";
+            *out_ << std::endl;
+        }
     }
  
     if (opt_.enable_pcm)
     {
-        std::cout << "PCM Metrics:"
+        *out_ << "PCM Metrics:"
                   << "\n"
                   << "\tL3 misses: " << getL3CacheMisses(*before_sstate, *after_sstate) << "\n"
                   << "\tDRAM Reads (bytes): " << getBytesReadFromMC(*before_sstate, *after_sstate) << "\n"
@@ -457,7 +1430,14 @@ void benchmark_t::run() noexcept
                   << "\tNVM Writes (bytes): " << getBytesWrittenToPMM(*before_sstate, *after_sstate) << std::endl;
     }
 
-    std::cout << "Samples:" << std::endl;
+    if (!load_trace_.empty() || !run_trace.empty())
+    {
+        *out_ << "Trace points:" << std::endl;
+        print_trace(*out_, "Load", load_trace_);
+        print_trace(*out_, trace_shared_ ? "Run (both co-located trees)" : "Run", run_trace);
+    }
+
+    *out_ << "Samples:" << std::endl;
     std::adjacent_difference(global_stats.begin(), global_stats.end(), global_stats.begin(),
                              [](const stats_t& x, const stats_t& y) {
                                  stats_t s;
@@ -466,18 +1446,50 @@ void benchmark_t::run() noexcept
                              });
 
     for (auto s : global_stats)
-        std::cout << "\t" << s.operation_count << std::endl;
+        *out_ << "\t" << s.operation_count << std::endl;
+
+    if (!run_trace.empty())
+    {
+        // One column per event traced during the run.
+        *out_ << (trace_shared_ ? "Trace samples of both co-located trees (" : "Trace samples (");
+        const char* sep = "";
+        for (size_t i = 0; i < TRACE_EVENTS; ++i)
+        {
+            if (run_trace.count[i] == 0)
+                continue;
+            *out_ << sep << trace_event_name(i);
+            sep = ", ";
+        }
+        *out_ << "):" << std::endl;
+
+        auto prev = trace_before;
+        for (auto& t : trace_samples)
+        {
+            auto d = t - prev;
+            for (size_t i = 0; i < TRACE_EVENTS; ++i)
+                if (run_trace.count[i] != 0)
+                    *out_ << "\t" << d.count[i];
+            *out_ << std::endl;
+            prev = t;
+        }
+    }
 
+    run_result_t result;
+    result.operations = op_num;
+    result.failed = op_num_f;
+    result.elapsed_ms = elapsed;
+    result.throughput = throughput;
+
+    std::vector<uint64_t> global_latencies;
     if(opt_.latency_sampling > 0.0)
     {
-        std::vector<uint64_t> global_latencies;
         for(auto& v : local_stats)
             for(unsigned int i=0; i<v.times.size(); i=i+2)
                 global_latencies.push_back(std::chrono::nanoseconds(v.times[i+1]-v.times[i]).count());
 
         std::sort(global_latencies.begin(), global_latencies.end());
         auto observed = global_latencies.size();
-        std::cout << "Latencies (" << observed << " operations observed):\n"
+        *out_ << "Latencies (" << observed << " operations observed):\n"
                   << "\tmin: " << global_latencies[0] << '\n'
                   << "\t50%: " << global_latencies[0.5*observed] << '\n'
                   << "\t90%: " << global_latencies[0.9*observed] << '\n'
@@ -486,81 +1498,1653 @@ void benchmark_t::run() noexcept
                   << "\t99.99%: " << global_latencies[0.9999*observed] << '\n'
                   << "\t99.999%: " << global_latencies[0.99999*observed] << '\n'
                   << "\tmax: " << global_latencies[observed-1] << std::endl;
+
+        result.p50 = global_latencies[0.5*observed];
+        result.p99 = global_latencies[0.99*observed];
+        result.p999 = global_latencies[0.999*observed];
     }
-}
 
-bool benchmark_t::run_op(operation_t operation, const char *key_ptr, char *value_out, char *values_out)
-{
-    bool r;
-    switch (operation)
+    if (jitter)
     {
-        case operation_t::READ:
+        // Only gaps that started while the workload was running.
+        std::vector<jitter_event_t> events;
+        for (auto& e : jitter->events())
+            if (e.start >= run_start && e.start < run_end)
+                events.push_back(e);
+
+        uint64_t stall_ns = 0;
+        uint64_t max_gap_ns = 0;
+        for (auto& e : events)
         {
-            r = tree_->find(key_ptr, key_generator_->size(), value_out);
-            assert(r);
-            break;
+            stall_ns += e.gap_ns;
+            max_gap_ns = std::max(max_gap_ns, e.gap_ns);
         }
 
-        case operation_t::INSERT:
+        *out_ << "Jitter (" << jitter->cpus().size() << " probes, threshold: " << opt_.jitter_threshold_ns << " ns):\n"
+                  << "\tProbe cpus:";
+        for (auto c : jitter->cpus())
+            *out_ << " " << c;
+        *out_ << "\n"
+                  << "\tGaps: " << events.size() << "\n"
+                  << "\tTotal stall: " << stall_ns / 1e6 << " ms\n"
+                  << "\tMax gap: " << max_gap_ns << " ns" << std::endl;
+
+        if (!global_latencies.empty())
         {
-            // Generate random value
-            auto value_ptr = value_generator_.next();
-            r = tree_->insert(key_ptr, key_generator_->size(), value_ptr, opt_.value_size);
-            assert(r);
-            break;
+            // Tail operations overlapping a gap were likely delayed by the platform, not the tree.
+            auto tail_ns = global_latencies[0.999*global_latencies.size()];
+            std::chrono::nanoseconds max_gap(max_gap_ns);
+            uint64_t tail = 0;
+            uint64_t noisy = 0;
+            for (auto& v : local_stats)
+            {
+                for (unsigned int i = 0; i < v.times.size(); i = i + 2)
+                {
+                    auto begin = v.times[i];
+                    auto end = v.times[i+1];
+                    if (static_cast<uint64_t>(std::chrono::nanoseconds(end - begin).count()) < tail_ns)
+                        continue;
+                    ++tail;
+
+                    auto it = std::lower_bound(events.begin(), events.end(), begin - max_gap,
+                                               [](const jitter_event_t& e, const std::chrono::high_resolution_clock::time_point& t) {
+                                                   return e.start < t;
+                                               });
+                    for (; it != events.end() && it->start < end; ++it)
+                    {
+                        if (it->start + std::chrono::nanoseconds(it->gap_ns) > begin)
+                        {
+                            ++noisy;
+                            break;
+                        }
+                    }
+                }
+            }
+            *out_ << "\t99.9% tail overlapping gaps: " << noisy << " of " << tail << " operations" << std::endl;
         }
 
-        case operation_t::UPDATE:
+        // Gaps per sampling window, aligned with "Samples".
+        std::vector<std::pair<uint64_t, uint64_t>> windows(global_stats.size());
+        std::chrono::milliseconds sampling_window(opt_.sampling_ms);
+        for (auto& e : events)
         {
-            // Generate random value
-            auto value_ptr = value_generator_.next();
-            r = tree_->update(key_ptr, key_generator_->size(), value_ptr, opt_.value_size);
-            assert(r);
-            break;
+            auto w = static_cast<size_t>((e.start - run_start) / sampling_window);
+            if (w < windows.size())
+            {
+                ++windows[w].first;
+                windows[w].second += e.gap_ns;
+            }
         }
 
-        case operation_t::REMOVE:
+        *out_ << "Jitter samples (gaps, stall ns):" << std::endl;
+        for (auto& w : windows)
+            *out_ << "\t" << w.first << "\t" << w.second << std::endl;
+    }
+
+    if(has_calibration_ && calibration_.dram_ns > 0)
+    {
+        // Express results in units of local DRAM accesses of this machine.
+        auto dram_ns = calibration_.dram_ns;
+        *out_ << "Normalized (DRAM latency: " << dram_ns << " ns):" << "\n"
+                  << "\tThroughput: " << throughput * dram_ns / 1e9 << " ops per DRAM latency" << std::endl;
+        if(opt_.latency_sampling > 0.0 && !global_latencies.empty())
         {
-            // TODO: Randomly deleting keys will cause false read,update and scan
-            r = tree_->remove(key_ptr, key_generator_->size());
-            assert(r);
-            break;
+            auto observed = global_latencies.size();
+            *out_ << "\t50% latency: " << global_latencies[0.5*observed] / dram_ns << " DRAM latencies\n"
+                      << "\t99% latency: " << global_latencies[0.99*observed] / dram_ns << " DRAM latencies\n"
+                      << "\t99.9% latency: " << global_latencies[0.999*observed] / dram_ns << " DRAM latencies" << std::endl;
         }
+        if(opt_.enable_pcm && calibration_.read_gbs > 0)
+        {
+            auto bytes = getBytesReadFromMC(*before_sstate, *after_sstate) + getBytesWrittenToMC(*before_sstate, *after_sstate);
+            *out_ << "\tDRAM bandwidth utilization: "
+                      << 100.0 * bytes / (elapsed * 1e6) / calibration_.read_gbs << "%" << std::endl;
+        }
+    }
 
-        case operation_t::SCAN:
+    result.latencies = std::move(global_latencies);
+    return result;
+}
+
+void benchmark_t::run_interference() noexcept
+{
+    auto cpus = topology::parse_cpu_list(opt_.interference_cpus);
+    if (cpus.empty())
+    {
+        // Workers are usually placed on the lowest cpus.
+        for (uint32_t c = std::thread::hardware_concurrency(); c > 0; --c)
+            cpus.push_back(c - 1);
+    }
+
+    std::vector<double> bandwidths;
+    std::vector<run_result_t> results;
+    for (auto threads : opt_.interference_threads)
+    {
+        std::vector<uint32_t> thread_cpus;
+        for (uint32_t i = 0; i < threads; ++i)
+            thread_cpus.push_back(cpus[i % cpus.size()]);
+
+        *out_ << "Interference (" << threads << " " << opt_.interference_kind << " threads):" << std::endl;
+        interference_t interference(opt_.interference_kind, opt_.interference_footprint);
+        interference.start(thread_cpus);
+        results.push_back(run());
+        interference.stop();
+        bandwidths.push_back(interference.bandwidth_gbs());
+    }
+
+    *out_ << "Interference sweep (" << opt_.interference_kind << ", "
+              << (opt_.interference_footprint >> 20) << " MB per thread):" << std::endl;
+    *out_ << "\tthreads\tGB/s\tops/s\tdegradation\t99% ns\t99.9% ns" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& r = results[i];
+        double degradation = results[0].throughput > 0 ? 100.0 * (1.0 - r.throughput / results[0].throughput) : 0.0;
+        *out_ << "\t" << opt_.interference_threads[i]
+                  << "\t" << bandwidths[i]
+                  << "\t" << r.throughput
+                  << "\t" << degradation << "%"
+                  << "\t" << r.p99
+                  << "\t" << r.p999 << std::endl;
+    }
+}
+
+void benchmark_t::run_long_scans() noexcept
+{
+    const bool snapshots = tree_->capabilities() & TREE_CAP_SNAPSHOT;
+    const size_t key_size = key_generator_->size();
+    const size_t record_size = key_size + opt_.value_size;
+    const uint32_t chunk = opt_.long_scan_chunk;
+
+    *out_ << "Baseline (no long scans):" << std::endl;
+    auto baseline = run();
+
+    struct alignas(64) scanner_stats_t
+    {
+        uint64_t scans = 0;
+        uint64_t records = 0;
+        uint64_t snapshot_bytes = 0;
+        std::vector<uint64_t> scan_ns;
+    };
+    std::vector<scanner_stats_t> stats(opt_.long_scan_threads);
+    std::atomic<bool> stop{false};
+
+    auto scanner = [&](scanner_stats_t& s) {
+        // Smallest key, then the last key of the previous chunk.
+        std::vector<char> key(key_size);
+        while (!stop.load(std::memory_order_relaxed))
         {
-            r = static_cast<bool>(tree_->scan(key_ptr, key_generator_->size(), opt_.scan_size, values_out));
-            assert(r);
-            break;
+            auto start = now_ns();
+            void* snapshot = snapshots ? tree_->snapshot_begin() : nullptr;
+
+            std::fill(key.begin(), key.end(), 0);
+            uint64_t scanned = 0;
+            bool done = false;
+            int skip = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                uint64_t remaining = opt_.long_scan_size - scanned;
+                int want = static_cast<int>(std::min<uint64_t>(chunk, remaining + skip));
+                char* values_out = nullptr;
+                int n = snapshot ? tree_->snapshot_scan(snapshot, key.data(), key_size, want, values_out)
+                                 : tree_->scan(key.data(), key_size, want, values_out);
+
+                // Continued chunks start at the last key already scanned.
+                if (n > skip)
+                {
+                    scanned += n - skip;
+                    memcpy(key.data(), values_out + (n - 1) * record_size, key_size);
+                }
+                if (n < want || scanned == opt_.long_scan_size)
+                {
+                    done = true;
+                    break;
+                }
+                skip = 1;
+            }
+
+            if (snapshot)
+            {
+                s.snapshot_bytes = std::max<uint64_t>(s.snapshot_bytes, tree_->snapshot_bytes(snapshot));
+                tree_->snapshot_end(snapshot);
+            }
+            s.records += scanned;
+            if (done)
+            {
+                ++s.scans;
+                s.scan_ns.push_back(now_ns() - start);
+            }
         }
+    };
 
-        default:
-            std::cout << "Error: unknown operation!" << std::endl;
-            exit(0);
-            break;
+    *out_ << "Long scans (" << opt_.long_scan_threads << " threads):" << std::endl;
+    stopwatch_t sw;
+    sw.start();
+    std::vector<std::thread> threads;
+    long_scans_running_ = true;
+    for (auto& s : stats)
+        threads.emplace_back(scanner, std::ref(s));
+    auto with_scans = run();
+    stop.store(true);
+    for (auto& t : threads)
+        t.join();
+    long_scans_running_ = false;
+    auto elapsed = sw.elapsed<std::chrono::milliseconds>();
+
+    uint64_t scans = 0;
+    uint64_t records = 0;
+    uint64_t snapshot_bytes = 0;
+    std::vector<uint64_t> scan_ns;
+    for (auto& s : stats)
+    {
+        scans += s.scans;
+        records += s.records;
+        snapshot_bytes = std::max(snapshot_bytes, s.snapshot_bytes);
+        scan_ns.insert(scan_ns.end(), s.scan_ns.begin(), s.scan_ns.end());
+    }
+    std::sort(scan_ns.begin(), scan_ns.end());
+
+    *out_ << "Long scan summary (" << (snapshots ? "snapshot" : "chunked scan, not consistent") << "):" << "\n"
+          << "\tScans completed: " << scans << "\n"
+          << "\tRecords scanned: " << records << "\n"
+          << "\tScan throughput: " << records / ((double)elapsed / 1000) << " records/s" << std::endl;
+    if (!scan_ns.empty())
+        *out_ << "\tScan time: " << scan_ns[0.5*scan_ns.size()] / 1e6 << " ms (50%), "
+              << scan_ns.back() / 1e6 << " ms (max)" << std::endl;
+    if (snapshots)
+        *out_ << "\tSnapshot memory: " << snapshot_bytes / (double)(1 << 20) << " MB (max per snapshot)" << std::endl;
+
+    // Percentiles are only measured with latency sampling.
+    const bool latencies = opt_.latency_sampling > 0;
+    *out_ << "Long scan impact:" << std::endl;
+    *out_ << "\trun\tops/s\tdegradation" << (latencies ? "\t50% ns\t99% ns\t99.9% ns" : "") << std::endl;
+    for (auto* r : {&baseline, &with_scans})
+    {
+        double degradation = baseline.throughput > 0 ? 100.0 * (1.0 - r->throughput / baseline.throughput) : 0.0;
+        *out_ << "\t" << (r == &baseline ? "baseline" : "long scans")
+              << "\t" << r->throughput
+              << "\t" << degradation << "%";
+        if (latencies)
+            *out_ << "\t" << r->p50
+                  << "\t" << r->p99
+                  << "\t" << r->p999;
+        *out_ << std::endl;
     }
-    return r;
 }
 
-} // namespace PiBench
+void benchmark_t::run_hints() noexcept
+{
+    *out_ << "Baseline (no hints):" << std::endl;
+    auto baseline = run();
+
+    *out_ << "With hints:" << std::endl;
+    use_hints_ = true;
+    auto hinted = run();
+    use_hints_ = false;
+
+    // Percentiles are only measured with latency sampling.
+    const bool latencies = opt_.latency_sampling > 0;
+    *out_ << "Hint impact:" << std::endl;
+    *out_ << "\trun\tops/s\tspeedup" << (latencies ? "\t50% ns\t99% ns\t99.9% ns" : "") << std::endl;
+    for (auto* r : {&baseline, &hinted})
+    {
+        double speedup = baseline.throughput > 0 ? r->throughput / baseline.throughput : 0.0;
+        *out_ << "\t" << (r == &baseline ? "baseline" : "hints")
+              << "\t" << r->throughput
+              << "\t" << speedup;
+        if (latencies)
+            *out_ << "\t" << r->p50
+                  << "\t" << r->p99
+                  << "\t" << r->p999;
+        *out_ << std::endl;
+    }
+    if (latencies)
+        *out_ << "\tSaved latency (50%): " << static_cast<int64_t>(baseline.p50) - static_cast<int64_t>(hinted.p50) << " ns" << std::endl;
+}
 
-namespace std
+run_result_t benchmark_t::run_transactions() noexcept
 {
-std::ostream& operator<<(std::ostream& os, const PiBench::distribution_t& dist)
+    const size_t key_size = key_generator_->size();
+    const uint64_t first_id = insert_id_ - opt_.num_records;
+
+    struct alignas(64) txn_stats_t
+    {
+        uint64_t committed = 0;
+        uint64_t aborts = 0;
+        uint64_t failed = 0;
+        uint64_t keys = 0;
+        std::vector<uint64_t> latencies;
+    };
+    std::vector<txn_stats_t> stats(opt_.num_threads);
+
+    stopwatch_t sw;
+    sw.start();
+    #pragma omp parallel num_threads(opt_.num_threads)
+    {
+        auto tid = omp_get_thread_num();
+
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[tid % cpus_.size()]);
+
+        key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
+        std::mt19937_64 rnd(opt_.rnd_seed * (tid + 1) + 1);
+        std::uniform_int_distribution<uint32_t> size_dist(opt_.txn_min_keys, opt_.txn_max_keys);
+        std::uniform_int_distribution<uint64_t> hot_dist(first_id, first_id + std::max<uint64_t>(opt_.txn_hot_keys, 1) - 1);
+        std::bernoulli_distribution hot_coin(opt_.txn_hot_keys > 0 ? opt_.txn_hot_ratio : 0.0);
+        std::bernoulli_distribution write_coin(opt_.txn_write_ratio);
+
+        std::vector<uint64_t> ids;
+        std::vector<bool> writes;
+        std::vector<char> keys(static_cast<size_t>(opt_.txn_max_keys) * key_size);
+        static thread_local char value_out[value_generator_t::VALUE_MAX];
+
+        auto& s = stats[tid];
+        s.latencies.reserve(opt_.num_ops / opt_.num_threads + 1);
+
+        #pragma omp for schedule(static)
+        for (uint64_t i = 0; i < opt_.num_ops; ++i)
+        {
+            // Distinct loaded records, so a transaction does not conflict with itself.
+            uint32_t size = size_dist(rnd);
+            ids.clear();
+            writes.clear();
+            while (ids.size() < size)
+            {
+                // Written keys follow the update distribution, read keys the read distribution.
+                bool write = write_coin(rnd);
+                uint64_t id;
+                if (hot_coin(rnd))
+                    id = hot_dist(rnd);
+                else
+                {
+                    operation_key_generator_t::select(write ? operation_t::UPDATE : operation_t::READ);
+                    key_generator_->next(false, false);
+                    id = key_generator_->last_id_;
+                }
+                if (id < first_id || id >= insert_id_ || std::find(ids.begin(), ids.end(), id) != ids.end())
+                    continue;
+                key_generator_->key_of(id, &keys[ids.size() * key_size]);
+                ids.push_back(id);
+                writes.push_back(write);
+            }
+
+            auto start = now_ns();
+            bool committed = false;
+            for (uint32_t attempt = 0; attempt < MAX_TXN_ATTEMPTS && !committed; ++attempt)
+            {
+                void* txn = tree_->txn_begin();
+                bool ok = txn != nullptr;
+                for (uint32_t k = 0; ok && k < size; ++k)
+                {
+                    const char* key = &keys[k * key_size];
+                    ok = writes[k] ? tree_->txn_write(txn, key, key_size, value_generator_.next(), opt_.value_size)
+                                   : tree_->txn_read(txn, key, key_size, value_out);
+                }
+
+                if (ok)
+                    committed = tree_->txn_commit(txn);
+                else if (txn)
+                    tree_->txn_abort(txn);
+
+                if (!committed)
+                    ++s.aborts;
+            }
+            s.latencies.push_back(now_ns() - start);
+
+            if (committed)
+            {
+                ++s.committed;
+                s.keys += size;
+            }
+            else
+                ++s.failed;
+        }
+    }
+    float elapsed = sw.elapsed<std::chrono::milliseconds>();
+
+    uint64_t committed = 0;
+    uint64_t aborts = 0;
+    uint64_t failed = 0;
+    uint64_t keys = 0;
+    std::vector<uint64_t> latencies;
+    for (auto& s : stats)
+    {
+        committed += s.committed;
+        aborts += s.aborts;
+        failed += s.failed;
+        keys += s.keys;
+        latencies.insert(latencies.end(), s.latencies.begin(), s.latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    uint64_t attempts = committed + aborts;
+    double throughput = elapsed > 0 ? committed / ((double)elapsed / 1000) : 0;
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "Transactions (" << opt_.txn_min_keys << "-" << opt_.txn_max_keys << " keys, "
+          << opt_.txn_write_ratio * 100 << "% writes, " << opt_.txn_hot_keys << " hot keys):" << "\n"
+          << "\tRun time: " << elapsed << " milliseconds" << "\n"
+          << "\tCommitted: " << committed << "\n"
+          << "\tCommit throughput: " << throughput << " txn/s" << "\n"
+          << "\tKeys per committed transaction: " << (committed > 0 ? (double)keys / committed : 0.0) << "\n"
+          << "\tAborts: " << aborts << "\n"
+          << "\tAbort rate: " << (attempts > 0 ? (float)aborts * 100.0 / attempts : 0.0) << "%" << "\n"
+          << "\tGave up after " << MAX_TXN_ATTEMPTS << " attempts: " << failed << std::endl;
+    print_percentiles(*out_, "Transaction latencies", latencies);
+
+    run_result_t result;
+    result.operations = committed + failed;
+    result.failed = failed;
+    result.elapsed_ms = elapsed;
+    result.throughput = throughput;
+    if (!latencies.empty())
+    {
+        result.p50 = latencies[0.5*latencies.size()];
+        result.p99 = latencies[0.99*latencies.size()];
+        result.p999 = latencies[0.999*latencies.size()];
+    }
+    result.latencies = std::move(latencies);
+    return result;
+}
+
+run_result_t benchmark_t::run_secondary_index(tree_api* secondary) noexcept
 {
-    switch (dist)
+    const size_t key_size = key_generator_->size();
+    const uint64_t first_id = insert_id_ - opt_.num_records;
+    const uint64_t current_id = insert_id_;
+    const uint64_t inserts_per_thread = 10 + (opt_.num_ops * opt_.insert_ratio) / opt_.num_threads;
+    const uint64_t max_id = std::max<uint64_t>(key_generator_->keyspace(), current_id + inserts_per_thread * opt_.num_threads);
+
+    // Attribute of a record, changed by every update. Ids of attributes never collide with primary ids.
+    std::unique_ptr<std::atomic<uint32_t>[]> versions(new std::atomic<uint32_t>[max_id + 1]());
+    auto attribute_of = [&](uint64_t id, uint32_t version, char* dst) {
+        key_generator_->key_of((static_cast<uint64_t>(version) + 1) << 40 | id, dst);
+    };
+
     {
-    case PiBench::distribution_t::UNIFORM:
-        return os << "UNIFORM";
-        break;
-    case PiBench::distribution_t::SELFSIMILAR:
-        return os << "SELFSIMILAR";
-        break;
-    case PiBench::distribution_t::ZIPFIAN:
-        return os << "ZIPFIAN";
-        break;
-    default:
-        return os << static_cast<uint8_t>(dist);
+        char pk[key_generator_t::KEY_MAX];
+        char sk[key_generator_t::KEY_MAX];
+        stopwatch_t sw;
+        sw.start();
+        for (uint64_t id = first_id; id < current_id; ++id)
+        {
+            key_generator_->key_of(id, pk);
+            attribute_of(id, 0, sk);
+            secondary->insert(sk, key_size, pk, key_size);
+        }
+        *out_ << "Secondary index:" << "\n"
+              << "\tLoad time: " << sw.elapsed<std::chrono::milliseconds>() << " milliseconds" << std::endl;
+    }
+
+    struct alignas(64) index_stats_t
+    {
+        uint64_t operations = 0;
+        uint64_t failed = 0;
+        uint64_t primary_ops = 0;
+        uint64_t secondary_ops = 0;
+        uint64_t primary_ns = 0;
+        uint64_t secondary_ns = 0;
+        std::vector<uint64_t> latencies;
+    };
+    std::vector<index_stats_t> stats(opt_.num_threads);
+
+    stopwatch_t sw;
+    sw.start();
+    #pragma omp parallel num_threads(opt_.num_threads)
+    {
+        auto tid = omp_get_thread_num();
+
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[tid % cpus_.size()]);
+
+        key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
+        auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
+        uint64_t next_insert = current_id + inserts_per_thread * tid;
+        const uint64_t insert_end = next_insert + inserts_per_thread;
+
+        char pk[key_generator_t::KEY_MAX];
+        char sk[key_generator_t::KEY_MAX];
+        static thread_local char value_out[value_generator_t::VALUE_MAX];
+        char* values_out = nullptr;
+
+        auto& s = stats[tid];
+        s.latencies.reserve(opt_.num_ops * opt_.latency_sampling / opt_.num_threads + 1);
+
+        #pragma omp for schedule(static)
+        for (uint64_t i = 0; i < opt_.num_ops; ++i)
+        {
+            auto op = op_generator_.next();
+            operation_key_generator_t::select(op);
+
+            uint64_t id;
+            if (op == operation_t::INSERT)
+            {
+                // Ids past the range reserved for this thread have no version, the insert fails.
+                if (next_insert == insert_end)
+                {
+                    ++s.operations;
+                    ++s.failed;
+                    continue;
+                }
+                id = next_insert++;
+            }
+            else
+            {
+                key_generator_->next(false, false);
+                id = key_generator_->last_id_;
+            }
+            assert(id <= max_id);
+            key_generator_->key_of(id, pk);
+            uint32_t version = versions[id].load(std::memory_order_acquire);
+            attribute_of(id, version, sk);
+
+            // Index calls of sampled operations are timed separately.
+            bool sampled = random_bool();
+            auto in_primary = [&](auto&& call) {
+                ++s.primary_ops;
+                if (!sampled)
+                    return call();
+                auto start = now_ns();
+                auto r = call();
+                s.primary_ns += now_ns() - start;
+                return r;
+            };
+            auto in_secondary = [&](auto&& call) {
+                ++s.secondary_ops;
+                if (!sampled)
+                    return call();
+                auto start = now_ns();
+                auto r = call();
+                s.secondary_ns += now_ns() - start;
+                return r;
+            };
+
+            auto start = sampled ? now_ns() : 0;
+            bool r = false;
+            switch (op)
+            {
+                case operation_t::READ:
+                {
+                    char found[key_generator_t::KEY_MAX];
+                    r = in_secondary([&] { return secondary->find(sk, key_size, found); })
+                        && in_primary([&] { return tree_->find(found, key_size, value_out); });
+                    break;
+                }
+
+                case operation_t::INSERT:
+                {
+                    auto value_ptr = value_generator_.next();
+                    r = in_primary([&] { return tree_->insert(pk, key_size, value_ptr, opt_.value_size); })
+                        && in_secondary([&] { return secondary->insert(sk, key_size, pk, key_size); });
+                    break;
+                }
+
+                case operation_t::UPDATE:
+                {
+                    auto value_ptr = value_generator_.next();
+                    r = in_primary([&] { return tree_->update(pk, key_size, value_ptr, opt_.value_size); });
+
+                    // Only the writer moving the record to the next attribute updates the secondary index.
+                    if (r && versions[id].compare_exchange_strong(version, version + 1, std::memory_order_acq_rel))
+                    {
+                        char next_sk[key_generator_t::KEY_MAX];
+                        attribute_of(id, version + 1, next_sk);
+                        r = in_secondary([&] { return secondary->remove(sk, key_size); })
+                            && in_secondary([&] { return secondary->insert(next_sk, key_size, pk, key_size); });
+                    }
+                    break;
+                }
+
+                case operation_t::REMOVE:
+                {
+                    r = in_primary([&] { return tree_->remove(pk, key_size); })
+                        && in_secondary([&] { return secondary->remove(sk, key_size); });
+                    break;
+                }
+
+                case operation_t::SCAN:
+                {
+                    int n = in_secondary([&] { return secondary->scan(sk, key_size, opt_.scan_size, values_out); });
+                    r = n > 0;
+                    for (int k = 0; k < n; ++k)
+                    {
+                        const char* found = values_out + k * 2 * key_size + key_size;
+                        r &= in_primary([&] { return tree_->find(found, key_size, value_out); });
+                    }
+                    break;
+                }
+
+                default:
+                    std::cout << "Error: unknown operation!" << std::endl;
+                    exit(0);
+                    break;
+            }
+            if (sampled)
+                s.latencies.push_back(now_ns() - start);
+
+            ++s.operations;
+            if (!r)
+                ++s.failed;
+        }
+    }
+    float elapsed = sw.elapsed<std::chrono::milliseconds>();
+
+    index_stats_t total;
+    std::vector<uint64_t> latencies;
+    for (auto& s : stats)
+    {
+        total.operations += s.operations;
+        total.failed += s.failed;
+        total.primary_ops += s.primary_ops;
+        total.secondary_ops += s.secondary_ops;
+        total.primary_ns += s.primary_ns;
+        total.secondary_ns += s.secondary_ns;
+        latencies.insert(latencies.end(), s.latencies.begin(), s.latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    insert_id_ = current_id + inserts_per_thread * opt_.num_threads;
+
+    double throughput = elapsed > 0 ? total.operations / ((double)elapsed / 1000) : 0;
+    uint64_t sampled = latencies.size();
+    uint64_t sampled_ns = std::accumulate(latencies.begin(), latencies.end(), uint64_t(0));
+    auto per_op = [&](double x) { return total.operations > 0 ? x / total.operations : 0.0; };
+    auto per_sample = [&](double x) { return sampled > 0 ? x / sampled : 0.0; };
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "\tRun time: " << elapsed << " milliseconds" << "\n"
+          << "\tLogical operations: " << total.operations << "\n"
+          << "\tThroughput: " << throughput << " ops/s" << "\n"
+          << "\tFalse access rate: " << (total.operations > 0 ? (float)total.failed * 100.0 / total.operations : 0.0) << "%" << "\n"
+          << "\tIndex operations per logical operation:" << "\n"
+          << "\t\tPrimary: " << per_op(total.primary_ops) << "\n"
+          << "\t\tSecondary: " << per_op(total.secondary_ops) << std::endl;
+    if (sampled > 0)
+        *out_ << "\tTime per logical operation (" << sampled << " sampled):" << "\n"
+              << "\t\tPrimary: " << per_sample(total.primary_ns) << " ns" << "\n"
+              << "\t\tSecondary: " << per_sample(total.secondary_ns) << " ns" << "\n"
+              << "\t\tOther: " << per_sample(sampled_ns - std::min(sampled_ns, total.primary_ns + total.secondary_ns)) << " ns" << std::endl;
+    print_percentiles(*out_, "Logical operation latencies", latencies);
+
+    run_result_t result;
+    result.operations = total.operations;
+    result.failed = total.failed;
+    result.elapsed_ms = elapsed;
+    result.throughput = throughput;
+    if (!latencies.empty())
+    {
+        result.p50 = latencies[0.5*latencies.size()];
+        result.p99 = latencies[0.99*latencies.size()];
+        result.p999 = latencies[0.999*latencies.size()];
+    }
+    result.latencies = std::move(latencies);
+    return result;
+}
+
+run_result_t benchmark_t::run_client_server() noexcept
+{
+    const uint32_t clients = opt_.num_clients;
+    const uint32_t servers = opt_.num_threads;
+    const size_t key_size = key_generator_->size();
+
+    // A client never has more than client_depth requests in flight, so rings never fill up.
+    std::vector<std::unique_ptr<spsc_ring_t<request_t>>> requests;
+    std::vector<std::unique_ptr<spsc_ring_t<request_t>>> responses;
+    for (uint32_t c = 0; c < clients; ++c)
+    {
+        requests.push_back(std::make_unique<spsc_ring_t<request_t>>(opt_.client_depth));
+        responses.push_back(std::make_unique<spsc_ring_t<request_t>>(opt_.client_depth));
+    }
+
+    struct alignas(64) client_stats_t
+    {
+        uint64_t operations = 0;
+        uint64_t failed = 0;
+        std::vector<uint64_t> latencies;
+        std::vector<uint64_t> queueing;
+    };
+    std::vector<client_stats_t> client_stats(clients);
+
+    // Number of batches of each size taken by each server.
+    std::vector<std::vector<uint64_t>> batch_sizes(servers, std::vector<uint64_t>(opt_.batch_size + 1, 0));
+
+    const uint64_t ops_per_client = opt_.num_ops / clients;
+    const uint64_t inserts_per_client = 10 + ops_per_client * opt_.insert_ratio;
+    const uint64_t current_id = insert_id_;
+
+    std::atomic<uint32_t> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<uint32_t> clients_done(0);
+
+    auto pin = [this](uint32_t i) {
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[i % cpus_.size()]);
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t s = 0; s < servers; ++s)
+    {
+        threads.emplace_back([&, s] {
+            pin(s);
+            std::vector<request_t> batch(opt_.batch_size);
+            char value_out[value_generator_t::VALUE_MAX];
+            char* values_out = nullptr;
+
+            ready.fetch_add(1);
+            while (!go.load())
+                std::this_thread::yield();
+
+            // Server s serves clients s, s + servers, ...
+            uint32_t idle_rounds = 0;
+            while (true)
+            {
+                bool idle = true;
+                for (uint32_t c = s; c < clients; c += servers)
+                {
+                    auto n = requests[c]->pop_batch(batch.data(), opt_.batch_size);
+                    if (n == 0)
+                        continue;
+
+                    idle = false;
+                    ++batch_sizes[s][n];
+                    auto dequeue_ns = now_ns();
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        auto& r = batch[i];
+                        r.dequeue_ns = dequeue_ns;
+                        r.result = run_op(r.op, r.key, value_out, values_out);
+                        while (!responses[c]->try_push(r))
+                            ;
+                    }
+                }
+
+                if (!idle)
+                    idle_rounds = 0;
+                else if (clients_done.load() == clients)
+                    break;
+                else if (++idle_rounds % IDLE_SPINS == 0)
+                    std::this_thread::yield(); // Let clients run if cpus are oversubscribed.
+            }
+        });
+    }
+
+    for (uint32_t c = 0; c < clients; ++c)
+    {
+        threads.emplace_back([&, c] {
+            pin(servers + c);
+            key_generator_->set_seed(opt_.rnd_seed * (c + 1));
+            key_generator_->current_id_ = current_id + inserts_per_client * c;
+            auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
+
+            auto& st = client_stats[c];
+            const uint64_t ops = c == clients - 1 ? opt_.num_ops - ops_per_client * (clients - 1) : ops_per_client;
+            if (opt_.latency_sampling > 0.0)
+            {
+                st.latencies.reserve(ops * opt_.latency_sampling * 1.2);
+                st.queueing.reserve(ops * opt_.latency_sampling * 1.2);
+            }
+
+            ready.fetch_add(1);
+            while (!go.load())
+                std::this_thread::yield();
+
+            uint64_t submitted = 0;
+            uint64_t outstanding = 0;
+            uint32_t idle_rounds = 0;
+            request_t r;
+            while (st.operations < ops)
+            {
+                while (outstanding < opt_.client_depth && submitted < ops)
+                {
+                    r.op = op_generator_.next();
+                    operation_key_generator_t::select(r.op);
+                    auto key_ptr = key_generator_->next(false, r.op == operation_t::INSERT);
+                    memcpy(r.key, key_ptr, key_size);
+                    r.sampled = random_bool();
+                    r.submit_ns = r.sampled ? now_ns() : 0;
+                    while (!requests[c]->try_push(r))
+                        ;
+                    ++submitted;
+                    ++outstanding;
+                }
+
+                if (responses[c]->empty() && ++idle_rounds % IDLE_SPINS == 0)
+                    std::this_thread::yield();
+
+                while (responses[c]->try_pop(r))
+                {
+                    if (r.sampled)
+                    {
+                        st.latencies.push_back(now_ns() - r.submit_ns);
+                        st.queueing.push_back(r.dequeue_ns - r.submit_ns);
+                    }
+                    if (!r.result)
+                        ++st.failed;
+                    ++st.operations;
+                    --outstanding;
+                }
+            }
+            clients_done.fetch_add(1);
+        });
+    }
+
+    while (ready.load() < servers + clients)
+        std::this_thread::yield();
+
+    stopwatch_t stopwatch;
+    stopwatch.start();
+    go.store(true);
+    for (auto& t : threads)
+        t.join();
+    float elapsed = stopwatch.elapsed<std::chrono::milliseconds>();
+
+    // Next run inserts after the ids reserved by this one.
+    insert_id_ = current_id + inserts_per_client * clients;
+
+    run_result_t result;
+    result.elapsed_ms = elapsed;
+    std::vector<uint64_t> queueing;
+    for (auto& st : client_stats)
+    {
+        result.operations += st.operations;
+        result.failed += st.failed;
+        result.latencies.insert(result.latencies.end(), st.latencies.begin(), st.latencies.end());
+        queueing.insert(queueing.end(), st.queueing.begin(), st.queueing.end());
+    }
+    result.throughput = result.operations / ((double)elapsed / 1000);
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "\tRun time: " << elapsed << " milliseconds" << std::endl;
+    *out_ << "\tThroughput: " << result.throughput << " ops/s" << std::endl;
+    *out_ << "\tFalse access rate: " << ((float)result.failed * 100.0 / result.operations) << "%" << std::endl;
+
+    // Batch size distribution over all servers.
+    std::vector<uint64_t> batches(opt_.batch_size + 1, 0);
+    for (auto& b : batch_sizes)
+        for (size_t n = 0; n < b.size(); ++n)
+            batches[n] += b[n];
+    uint64_t num_batches = std::accumulate(batches.begin(), batches.end(), uint64_t(0));
+
+    *out_ << "Server batches (" << num_batches << " batches, " << servers << " servers, "
+          << clients << " clients):" << std::endl;
+    if (num_batches > 0)
+    {
+        auto batch_percentile = [&](double p) {
+            uint64_t seen = 0;
+            for (size_t n = 1; n < batches.size(); ++n)
+            {
+                seen += batches[n];
+                if (seen >= p * num_batches)
+                    return n;
+            }
+            return batches.size() - 1;
+        };
+        *out_ << "\tmean: " << (double)result.operations / num_batches << "\n"
+              << "\t50%: " << batch_percentile(0.5) << "\n"
+              << "\t99%: " << batch_percentile(0.99) << "\n"
+              << "\tmax: " << batch_percentile(1.0) << std::endl;
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    std::sort(queueing.begin(), queueing.end());
+    print_percentiles(*out_, "End-to-end latencies", result.latencies);
+    print_percentiles(*out_, "Queueing", queueing);
+
+    if (!result.latencies.empty())
+    {
+        auto observed = result.latencies.size();
+        result.p50 = result.latencies[0.5*observed];
+        result.p99 = result.latencies[0.99*observed];
+        result.p999 = result.latencies[0.999*observed];
+    }
+    return result;
+}
+
+run_result_t benchmark_t::run_virtual_clients() noexcept
+{
+    const uint32_t clients = opt_.virtual_clients;
+    const double think_ns = opt_.think_time_us * 1000.0;
+
+    /// State of a virtual client between requests.
+    struct virtual_client_t
+    {
+        /// Random state for think time (xorshift64).
+        uint64_t rnd;
+
+        /// Requests completed.
+        uint64_t requests;
+
+        /// Sum of request latencies.
+        uint64_t latency_sum;
+    };
+
+    struct alignas(64) worker_stats_t
+    {
+        uint64_t operations = 0;
+        uint64_t failed = 0;
+        std::vector<uint64_t> response;
+        std::vector<uint64_t> service;
+        std::vector<virtual_client_t> clients;
+    };
+    std::vector<worker_stats_t> worker_stats(opt_.num_threads);
+
+    uint64_t inserts_per_thread = 10 + (opt_.num_ops * opt_.insert_ratio) / opt_.num_threads;
+    uint64_t current_id = insert_id_;
+
+    stopwatch_t stopwatch;
+    float elapsed = 0.0;
+
+    #pragma omp parallel num_threads(opt_.num_threads)
+    {
+        auto tid = omp_get_thread_num();
+
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[tid % cpus_.size()]);
+
+        key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
+        key_generator_->current_id_ = current_id + (inserts_per_thread * tid);
+        auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
+
+        auto& st = worker_stats[tid];
+        st.clients.resize(clients);
+
+        // Samples must not reallocate inside the measured loop, leave slack for the sampling rate.
+        if (opt_.latency_sampling > 0.0)
+        {
+            const uint64_t ops = opt_.num_ops / opt_.num_threads + 1;
+            st.response.reserve(ops * opt_.latency_sampling * 1.2 + 64);
+            st.service.reserve(ops * opt_.latency_sampling * 1.2 + 64);
+        }
+        for (uint32_t c = 0; c < clients; ++c)
+            st.clients[c] = {utils::multiplicative_hash<uint64_t>(opt_.rnd_seed + (uint64_t(tid) << 32) + c) | 1, 0, 0};
+
+        auto think = [this, think_ns](virtual_client_t& client) -> int64_t {
+            client.rnd ^= client.rnd << 13;
+            client.rnd ^= client.rnd >> 7;
+            client.rnd ^= client.rnd << 17;
+            double u = (client.rnd >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+            return draw_delay(opt_.think_distribution, think_ns, u);
+        };
+
+        static thread_local char value_out[value_generator_t::VALUE_MAX];
+        char* values_out = nullptr;
+
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            stopwatch.start();
+        }
+
+        // Clients ordered by the time they issue their next request.
+        using ready_t = std::pair<int64_t, uint32_t>;
+        std::priority_queue<ready_t, std::vector<ready_t>, std::greater<ready_t>> ready;
+        auto start = now_ns();
+        for (uint32_t c = 0; c < clients; ++c)
+            ready.push({start + think(st.clients[c]), c});
+
+        #pragma omp for schedule(static)
+        for (uint64_t i = 0; i < opt_.num_ops; ++i)
+        {
+            auto next = ready.top();
+            ready.pop();
+
+            // Wait for the client, sleep if it is far away.
+            auto now = now_ns();
+            if (next.first - now > 100000)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(next.first - now - 50000));
+            while (now < next.first)
+                now = now_ns();
+
+            auto op = op_generator_.next();
+            operation_key_generator_t::select(op);
+            auto key_ptr = key_generator_->next(false, op == operation_t::INSERT);
+            if (!run_op(op, key_ptr, value_out, values_out))
+                ++st.failed;
+            ++st.operations;
+
+            auto end = now_ns();
+            auto& client = st.clients[next.second];
+            ++client.requests;
+            client.latency_sum += end - next.first;
+            if (random_bool())
+            {
+                st.response.push_back(end - next.first);
+                st.service.push_back(end - now);
+            }
+            ready.push({end + think(client), next.second});
+        }
+
+        #pragma omp single nowait
+        {
+            elapsed = stopwatch.elapsed<std::chrono::milliseconds>();
+        }
+    }
+
+    insert_id_ = current_id + inserts_per_thread * opt_.num_threads;
+
+    run_result_t result;
+    result.elapsed_ms = elapsed;
+    std::vector<uint64_t> service;
+    std::vector<uint64_t> requests;
+    std::vector<uint64_t> mean_latencies;
+    for (auto& st : worker_stats)
+    {
+        result.operations += st.operations;
+        result.failed += st.failed;
+        result.latencies.insert(result.latencies.end(), st.response.begin(), st.response.end());
+        service.insert(service.end(), st.service.begin(), st.service.end());
+        for (auto& c : st.clients)
+        {
+            requests.push_back(c.requests);
+            if (c.requests > 0)
+                mean_latencies.push_back(c.latency_sum / c.requests);
+        }
+    }
+    result.throughput = result.operations / ((double)elapsed / 1000);
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "\tRun time: " << elapsed << " milliseconds" << std::endl;
+    *out_ << "\tThroughput: " << result.throughput << " ops/s" << std::endl;
+    *out_ << "\tFalse access rate: " << ((float)result.failed * 100.0 / result.operations) << "%" << std::endl;
+
+    std::sort(requests.begin(), requests.end());
+    std::sort(mean_latencies.begin(), mean_latencies.end());
+    *out_ << "Virtual clients (" << opt_.num_threads << " * " << clients << " clients, think time: "
+          << opt_.think_distribution << " " << opt_.think_time_us << " us):" << std::endl;
+    *out_ << "\tRequests per client: " << requests.front() << " min, "
+          << requests[0.5*requests.size()] << " median, " << requests.back() << " max" << std::endl;
+    if (!mean_latencies.empty())
+        *out_ << "\tMean latency per client: " << mean_latencies.front() << " min, "
+              << mean_latencies[0.5*mean_latencies.size()] << " median, " << mean_latencies.back() << " max" << std::endl;
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    std::sort(service.begin(), service.end());
+    print_percentiles(*out_, "Response latencies", result.latencies);
+    print_percentiles(*out_, "Service latencies", service);
+
+    if (!result.latencies.empty())
+    {
+        auto observed = result.latencies.size();
+        result.p50 = result.latencies[0.5*observed];
+        result.p99 = result.latencies[0.99*observed];
+        result.p999 = result.latencies[0.999*observed];
+    }
+    return result;
+}
+
+run_result_t benchmark_t::run_schedule(const arrival_schedule_t& schedule) noexcept
+{
+    const int64_t window_ns = static_cast<int64_t>(opt_.sampling_ms) * 1000000;
+    const size_t num_windows = static_cast<size_t>(schedule.duration() * 1000 / opt_.sampling_ms) + 1;
+
+    struct alignas(64) worker_stats_t
+    {
+        uint64_t operations = 0;
+        uint64_t failed = 0;
+
+        /// Requests that arrived and completed in each window.
+        std::vector<uint64_t> arrived;
+        std::vector<uint64_t> completed;
+
+        /// Window of completion and latency of sampled requests.
+        std::vector<std::pair<uint32_t, uint64_t>> latencies;
+    };
+    std::vector<worker_stats_t> worker_stats(opt_.num_threads);
+
+    // Poisson arrivals can exceed the expected number.
+    uint64_t expected_inserts = schedule.expected_arrivals() * opt_.insert_ratio;
+    uint64_t inserts_per_thread = 1000 + 1.2 * expected_inserts / opt_.num_threads;
+    uint64_t current_id = insert_id_;
+
+    int64_t start = 0;
+    stopwatch_t stopwatch;
+    float elapsed = 0.0;
+
+    #pragma omp parallel num_threads(opt_.num_threads)
+    {
+        auto tid = omp_get_thread_num();
+
+        if (!cpus_.empty())
+            topology::pin_thread(cpus_[tid % cpus_.size()]);
+
+        key_generator_->set_seed(opt_.rnd_seed * (tid + 1));
+        key_generator_->current_id_ = current_id + (inserts_per_thread * tid);
+        auto random_bool = std::bind(std::bernoulli_distribution(opt_.latency_sampling), std::knuth_b());
+        std::mt19937_64 arrivals(opt_.rnd_seed * (tid + 1));
+
+        auto& st = worker_stats[tid];
+        st.arrived.resize(num_windows);
+        st.completed.resize(num_windows);
+
+        static thread_local char value_out[value_generator_t::VALUE_MAX];
+        char* values_out = nullptr;
+
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            stopwatch.start();
+            start = now_ns();
+        }
+
+        const double scale = 1.0 / opt_.num_threads;
+        for (double a = schedule.next_arrival(0, scale, arrivals); a < schedule.duration();
+             a = schedule.next_arrival(a, scale, arrivals))
+        {
+            // Wait for the arrival, sleep if it is far away.
+            int64_t due = start + static_cast<int64_t>(a * 1e9);
+            auto now = now_ns();
+            if (due - now > 100000)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - 50000));
+            while (now < due)
+                now = now_ns();
+
+            auto op = op_generator_.next();
+            operation_key_generator_t::select(op);
+            auto key_ptr = key_generator_->next(false, op == operation_t::INSERT);
+            if (!run_op(op, key_ptr, value_out, values_out))
+                ++st.failed;
+            ++st.operations;
+
+            auto end = now_ns();
+            size_t w = (end - start) / window_ns;
+            if (w >= st.completed.size())
+            {
+                st.arrived.resize(w + 1);
+                st.completed.resize(w + 1);
+            }
+            ++st.arrived[(due - start) / window_ns];
+            ++st.completed[w];
+            if (random_bool())
+                st.latencies.push_back({static_cast<uint32_t>(w), end - due});
+        }
+
+        #pragma omp critical
+        {
+            elapsed = std::max(elapsed, stopwatch.elapsed<std::chrono::milliseconds>());
+        }
+    }
+
+    insert_id_ = current_id + inserts_per_thread * opt_.num_threads;
+
+    run_result_t result;
+    result.elapsed_ms = elapsed;
+    size_t windows = 0;
+    for (auto& st : worker_stats)
+    {
+        result.operations += st.operations;
+        result.failed += st.failed;
+        windows = std::max(windows, st.completed.size());
+    }
+    result.throughput = result.operations / ((double)elapsed / 1000);
+
+    std::vector<uint64_t> arrived(windows, 0);
+    std::vector<uint64_t> completed(windows, 0);
+    std::vector<std::vector<uint64_t>> window_latencies(windows);
+    for (auto& st : worker_stats)
+    {
+        for (size_t w = 0; w < st.completed.size(); ++w)
+        {
+            arrived[w] += st.arrived[w];
+            completed[w] += st.completed[w];
+        }
+        for (auto& l : st.latencies)
+        {
+            window_latencies[l.first].push_back(l.second);
+            result.latencies.push_back(l.second);
+        }
+    }
+
+    *out_ << std::fixed << std::setprecision(4);
+    *out_ << "\tRun time: " << elapsed << " milliseconds" << std::endl;
+    *out_ << "\tThroughput: " << result.throughput << " ops/s" << std::endl;
+    *out_ << "\tFalse access rate: " << ((float)result.failed * 100.0 / result.operations) << "%" << std::endl;
+    *out_ << "\tScheduled: " << schedule.expected_arrivals() << " requests in " << schedule.duration() << " seconds" << std::endl;
+
+    // Backlog is the number of requests arrived but not completed at the end of a window.
+    *out_ << "Arrival timeline (" << opt_.sampling_ms << " ms windows):" << std::endl;
+    *out_ << "\ttime ms\tscheduled/s\tarrived\tcompleted\tbacklog\t50% ns\t99% ns" << std::endl;
+    int64_t backlog = 0;
+    for (size_t w = 0; w < windows; ++w)
+    {
+        backlog += arrived[w] - completed[w];
+        auto& l = window_latencies[w];
+        std::sort(l.begin(), l.end());
+        // Mean scheduled rate over the window.
+        double rate = 0;
+        for (int i = 0; i < 32; ++i)
+            rate += schedule.rate((w + (i + 0.5) / 32) * opt_.sampling_ms / 1000.0) / 32;
+
+        *out_ << "\t" << w * opt_.sampling_ms
+              << "\t" << rate
+              << "\t" << arrived[w]
+              << "\t" << completed[w]
+              << "\t" << backlog
+              << "\t" << (l.empty() ? 0 : l[0.5*l.size()])
+              << "\t" << (l.empty() ? 0 : l[0.99*l.size()]) << std::endl;
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    print_percentiles(*out_, "Latencies", result.latencies);
+
+    if (!result.latencies.empty())
+    {
+        auto observed = result.latencies.size();
+        result.p50 = result.latencies[0.5*observed];
+        result.p99 = result.latencies[0.99*observed];
+        result.p999 = result.latencies[0.999*observed];
+    }
+    return result;
+}
+
+void run_colocated(benchmark_t& first, benchmark_t& second,
+                   const std::string& first_name, const std::string& second_name)
+{
+    std::cout << "Solo (" << first_name << "):" << std::endl;
+    auto first_solo = first.run();
+    std::cout << "Solo (" << second_name << "):" << std::endl;
+    auto second_solo = second.run();
+
+    // Reports of concurrent runs are buffered so they do not interleave.
+    std::ostringstream first_out;
+    std::ostringstream second_out;
+    first.set_output(first_out);
+    second.set_output(second_out);
+    first.set_trace_shared(true);
+    second.set_trace_shared(true);
+
+    run_result_t second_co;
+    std::thread second_thread([&second, &second_co] { second_co = second.run(); });
+    auto first_co = first.run();
+    second_thread.join();
+
+    first.set_output(std::cout);
+    second.set_output(std::cout);
+    first.set_trace_shared(false);
+    second.set_trace_shared(false);
+
+    std::cout << "Co-located (" << first_name << "):\n" << first_out.str()
+              << "Co-located (" << second_name << "):\n" << second_out.str();
+
+    std::cout << "Co-location:" << std::endl;
+    std::cout << "\ttenant\tsolo ops/s\tco-located ops/s\tdegradation\tsolo 99% ns\tco-located 99% ns" << std::endl;
+    auto print_tenant = [](const std::string& name, const run_result_t& solo, const run_result_t& co) {
+        double degradation = solo.throughput > 0 ? 100.0 * (1.0 - co.throughput / solo.throughput) : 0.0;
+        std::cout << "\t" << name
+                  << "\t" << solo.throughput
+                  << "\t" << co.throughput
+                  << "\t" << degradation << "%"
+                  << "\t" << solo.p99
+                  << "\t" << co.p99 << std::endl;
+    };
+    print_tenant(first_name, first_solo, first_co);
+    print_tenant(second_name, second_solo, second_co);
+}
+
+bool benchmark_t::run_op(operation_t operation, const char *key_ptr, char *value_out, char *values_out)
+{
+    if (opt_.duplicates > 0 && (operation == operation_t::READ || operation == operation_t::INSERT || operation == operation_t::REMOVE))
+        return run_multimap_op(operation, key_ptr);
+
+    bool r;
+    switch (operation)
+    {
+        case operation_t::READ:
+        {
+            if (thread_hint)
+            {
+                ++thread_hinted_ops;
+                r = tree_->find_hint(thread_hint, key_ptr, key_generator_->size(), value_out);
+            }
+            else
+                r = tree_->find(key_ptr, key_generator_->size(), value_out);
+            assert(r);
+            break;
+        }
+
+        case operation_t::INSERT:
+        {
+            // Generate random value
+            auto value_ptr = value_generator_.next();
+            if (thread_hint)
+            {
+                ++thread_hinted_ops;
+                r = tree_->insert_hint(thread_hint, key_ptr, key_generator_->size(), value_ptr, opt_.value_size);
+            }
+            else
+                r = tree_->insert(key_ptr, key_generator_->size(), value_ptr, opt_.value_size);
+            assert(r);
+            break;
+        }
+
+        case operation_t::UPDATE:
+        {
+            // Generate random value
+            auto value_ptr = value_generator_.next();
+            r = tree_->update(key_ptr, key_generator_->size(), value_ptr, opt_.value_size);
+            assert(r);
+            break;
+        }
+
+        case operation_t::REMOVE:
+        {
+            // TODO: Randomly deleting keys will cause false read,update and scan
+            r = tree_->remove(key_ptr, key_generator_->size());
+            assert(r);
+            break;
+        }
+
+        case operation_t::SCAN:
+        {
+            r = static_cast<bool>(tree_->scan(key_ptr, key_generator_->size(), opt_.scan_size, values_out));
+            assert(r);
+            break;
+        }
+
+        case operation_t::AGGREGATE:
+        {
+            tree_aggregate_t result;
+            run_aggregate(key_ptr, result);
+            thread_records_aggregated += result.count;
+            r = result.count > 0;
+            assert(r);
+            break;
+        }
+
+        case operation_t::SEEK:
+        {
+            bool exact = false;
+            r = run_seek(key_ptr, value_out, exact);
+            ++thread_seeks;
+            thread_seeks_found += r;
+            thread_seeks_exact += exact;
+            break;
+        }
+
+        case operation_t::REMOVE_RANGE:
+        {
+            auto start = now_ns();
+            auto removed = run_remove_range(key_ptr);
+            thread_range_remove_ns += now_ns() - start;
+            thread_records_range_removed += removed;
+            r = removed > 0;
+            break;
+        }
+
+        default:
+            std::cout << "Error: unknown operation!" << std::endl;
+            exit(0);
+            break;
+    }
+    return r;
+}
+
+bool benchmark_t::run_op_u64(operation_t operation, uint64_t key)
+{
+    uint64_t value;
+    bool r;
+    switch (operation)
+    {
+        case operation_t::READ:
+            r = tree_->find_u64(key, value);
+            break;
+
+        case operation_t::INSERT:
+            memcpy(&value, value_generator_.next(), sizeof(value));
+            r = tree_->insert_u64(key, value);
+            break;
+
+        case operation_t::UPDATE:
+            memcpy(&value, value_generator_.next(), sizeof(value));
+            r = tree_->update_u64(key, value);
+            break;
+
+        case operation_t::REMOVE:
+            r = tree_->remove_u64(key);
+            break;
+
+        default:
+            std::cout << "Error: unknown operation!" << std::endl;
+            exit(0);
+            break;
+    }
+    assert(r);
+    return r;
+}
+
+bool benchmark_t::run_multimap_op(operation_t operation, const char* key_ptr)
+{
+    const uint64_t id = key_generator_->last_id_;
+    const size_t key_size = key_generator_->size();
+    switch (operation)
+    {
+        case operation_t::READ:
+        {
+            char* values_out;
+            return tree_->find_all(key_ptr, key_size, values_out) > 0;
+        }
+
+        case operation_t::INSERT:
+        {
+            // All records of a new key, as in the load phase.
+            bool r = true;
+            auto count = duplicates_of(id);
+            for (uint32_t j = 0; j < count; ++j)
+                r &= tree_->insert_dup(key_ptr, key_size, duplicate_value(id, j), opt_.value_size);
+            return r;
+        }
+
+        default: // REMOVE
+        {
+            if (opt_.remove_all_duplicates)
+                return tree_->remove_all(key_ptr, key_size) > 0;
+
+            // A random record of the key, it fails if the record was removed before.
+            static thread_local uint64_t removes = 0;
+            uint32_t j = utils::multiplicative_hash<uint64_t>(id ^ (++removes << 32)) % duplicates_of(id);
+            return tree_->remove_one(key_ptr, key_size, duplicate_value(id, j), opt_.value_size);
+        }
+    }
+}
+
+void benchmark_t::run_aggregate(const char* key_ptr, tree_aggregate_t& result)
+{
+    const size_t key_size = key_generator_->size();
+    if (aggregate_pushdown_)
+    {
+        tree_->aggregate(key_ptr, key_size, opt_.aggregate_size, result);
+        return;
+    }
+
+    // Scan the range in chunks, continued chunks start at the last key already aggregated.
+    const size_t record_size = key_size + opt_.value_size;
+    char key[key_generator_t::KEY_MAX];
+    memcpy(key, key_ptr, key_size);
+
+    result = tree_aggregate_t{};
+    int skip = 0;
+    while (result.count < opt_.aggregate_size)
+    {
+        int want = static_cast<int>(std::min<uint64_t>(MAX_SCAN, opt_.aggregate_size - result.count + skip));
+        char* values_out = nullptr;
+        int n = tree_->scan(key, key_size, want, values_out);
+        for (int i = skip; i < n; ++i)
+        {
+            uint64_t v = 0;
+            memcpy(&v, values_out + i * record_size + key_size, std::min<size_t>(sizeof(v), opt_.value_size));
+            ++result.count;
+            result.sum += v;
+            result.min = std::min(result.min, v);
+            result.max = std::max(result.max, v);
+        }
+        if (n < want)
+            break;
+        memcpy(key, values_out + (n - 1) * record_size, key_size);
+        skip = 1;
+    }
+}
+
+bool benchmark_t::run_seek(const char* key_ptr, char* value_out, bool& exact)
+{
+    const size_t key_size = key_generator_->size();
+    char key_out[key_generator_t::KEY_MAX];
+    bool found;
+    if (seek_pushdown_)
+    {
+        switch (opt_.seek_type)
+        {
+            case seek_t::UPPER_BOUND:
+                found = tree_->upper_bound(key_ptr, key_size, key_out, value_out);
+                break;
+            case seek_t::PREDECESSOR:
+                found = tree_->predecessor(key_ptr, key_size, key_out, value_out);
+                break;
+            default:
+                found = tree_->lower_bound(key_ptr, key_size, key_out, value_out);
+        }
+    }
+    else
+    {
+        // Predecessors cannot be found by scans, they require TREE_CAP_SEEK.
+        const bool upper = opt_.seek_type == seek_t::UPPER_BOUND;
+        char* values_out = nullptr;
+        int n = tree_->scan(key_ptr, key_size, upper ? 2 : 1, values_out);
+        int i = upper && n > 0 && memcmp(values_out, key_ptr, key_size) == 0 ? 1 : 0;
+        found = n > i;
+        if (found)
+        {
+            const char* record = values_out + i * (key_size + opt_.value_size);
+            memcpy(key_out, record, key_size);
+            memcpy(value_out, record + key_size, opt_.value_size);
+        }
+    }
+    exact = found && memcmp(key_out, key_ptr, key_size) == 0;
+    return found;
+}
+
+const char* benchmark_t::walk_key(const char* key_ptr)
+{
+    const size_t key_size = key_generator_->size();
+    auto& walk = thread_walk;
+    if (walk.pos == walk.len)
+    {
+        // Keys of the next records in key order are only known to the tree.
+        char* values_out = nullptr;
+        int n = tree_->scan(key_ptr, key_size, opt_.locality_run, values_out);
+        if (n <= 0)
+            return key_ptr;
+
+        walk.keys.resize(static_cast<size_t>(n) * key_size);
+        for (int i = 0; i < n; ++i)
+            memcpy(&walk.keys[i * key_size], values_out + i * (key_size + opt_.value_size), key_size);
+        walk.pos = 0;
+        walk.len = n;
+    }
+    return &walk.keys[walk.pos++ * key_size];
+}
+
+uint64_t benchmark_t::run_remove_range(const char* key_ptr)
+{
+    const size_t key_size = key_generator_->size();
+    if (remove_range_pushdown_)
+        return tree_->remove_range(key_ptr, key_size, opt_.remove_range_size);
+
+    // Scanned keys are removed, so the next chunk starts after the last one.
+    const size_t record_size = key_size + opt_.value_size;
+    char key[key_generator_t::KEY_MAX];
+    memcpy(key, key_ptr, key_size);
+
+    static thread_local std::vector<char> keys;
+    keys.resize(MAX_SCAN * key_size);
+
+    uint64_t scanned = 0;
+    uint64_t removed = 0;
+    while (scanned < opt_.remove_range_size)
+    {
+        int want = static_cast<int>(std::min<uint64_t>(MAX_SCAN, opt_.remove_range_size - scanned));
+        char* values_out = nullptr;
+        int n = tree_->scan(key, key_size, want, values_out);
+
+        // Removes may invalidate the scan buffer.
+        for (int i = 0; i < n; ++i)
+            memcpy(&keys[i * key_size], values_out + i * record_size, key_size);
+        for (int i = 0; i < n; ++i)
+            removed += tree_->remove(&keys[i * key_size], key_size);
+
+        scanned += n;
+        if (n < want)
+            break;
+        memcpy(key, &keys[(n - 1) * key_size], key_size);
+    }
+    return removed;
+}
+
+uint32_t benchmark_t::duplicates_of(uint64_t id) const noexcept
+{
+    // Drawn from a hash of the id, so all threads and runs agree.
+    double u = (utils::multiplicative_hash<uint64_t>(id ^ opt_.rnd_seed) >> 11) * (1.0 / 9007199254740992.0);
+    auto it = std::upper_bound(duplicate_cdf_.begin(), duplicate_cdf_.end(), u);
+    return std::min<uint32_t>(it - duplicate_cdf_.begin() + 1, opt_.duplicates);
+}
+
+const char* benchmark_t::duplicate_value(uint64_t id, uint32_t j) const noexcept
+{
+    // Values identify records like row ids of a secondary index.
+    static thread_local char value[value_generator_t::VALUE_MAX];
+    uint64_t row = (id << 20) | j;
+    memset(value, 0, opt_.value_size);
+    memcpy(value, &row, std::min<size_t>(sizeof(row), opt_.value_size));
+    return value;
+}
+
+} // namespace PiBench
+
+namespace std
+{
+std::ostream& operator<<(std::ostream& os, const PiBench::distribution_t& dist)
+{
+    switch (dist)
+    {
+    case PiBench::distribution_t::UNIFORM:
+        return os << "UNIFORM";
+        break;
+    case PiBench::distribution_t::SELFSIMILAR:
+        return os << "SELFSIMILAR";
+        break;
+    case PiBench::distribution_t::ZIPFIAN:
+        return os << "ZIPFIAN";
+        break;
+    default:
+        return os << static_cast<uint8_t>(dist);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const PiBench::delay_distribution_t& dist)
+{
+    switch (dist)
+    {
+    case PiBench::delay_distribution_t::FIXED:
+        return os << "FIXED";
+    case PiBench::delay_distribution_t::UNIFORM:
+        return os << "UNIFORM";
+    case PiBench::delay_distribution_t::EXPONENTIAL:
+        return os << "EXPONENTIAL";
+    default:
+        return os << static_cast<uint8_t>(dist);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const PiBench::seek_t& seek)
+{
+    switch (seek)
+    {
+    case PiBench::seek_t::LOWER_BOUND:
+        return os << "LOWER_BOUND";
+    case PiBench::seek_t::UPPER_BOUND:
+        return os << "UPPER_BOUND";
+    case PiBench::seek_t::PREDECESSOR:
+        return os << "PREDECESSOR";
+    default:
+        return os << static_cast<uint8_t>(seek);
     }
 }
 
@@ -583,13 +3167,31 @@ std::ostream& operator<<(std::ostream& os, const PiBench::options_t& opt)
                ? "(" + std::to_string(opt.key_skew) + ")"
                : "")
        << "\n"
+       << "\tKey distributions:\n"
+       << "\t\tRead: " << (opt.read_distribution.empty() ? "default" : opt.read_distribution) << "\n"
+       << "\t\tUpdate: " << (opt.update_distribution.empty() ? "default" : opt.update_distribution) << "\n"
+       << "\t\tDelete: " << (opt.remove_distribution.empty() ? "default" : opt.remove_distribution) << "\n"
+       << "\t\tScan: " << (opt.scan_distribution.empty() ? "default" : opt.scan_distribution) << "\n"
        << "\tScan size: " << opt.scan_size << "\n"
+       << "\tAggregate size: " << opt.aggregate_size << "\n"
+       << "\tRemove range size: " << opt.remove_range_size << "\n"
+       << "\tSeek type: " << opt.seek_type << "\n"
+       << "\tTyped keys: " << std::boolalpha << opt.typed_keys << std::noboolalpha << "\n"
+       << "\tAging ops: " << opt.aging_ops << "\n"
+       << "\tTTL: " << opt.ttl_ms << " ms\n"
+       << "\tDuplicates: " << opt.duplicates << "\n"
+       << "\tLocality run: " << opt.locality_run << "\n"
+       << "\tTransactions: " << std::boolalpha << opt.transactions << std::noboolalpha << "\n"
+       << "\tSecondary index: " << (opt.secondary_index.empty() ? "none" : opt.secondary_index) << "\n"
        << "\tOperations ratio:\n"
        << "\t\tRead: " << opt.read_ratio << "\n"
        << "\t\tInsert: " << opt.insert_ratio << "\n"
        << "\t\tUpdate: " << opt.update_ratio << "\n"
        << "\t\tDelete: " << opt.remove_ratio << "\n"
        << "\t\tScan: " << opt.scan_ratio << "\n"
+       << "\t\tAggregate: " << opt.aggregate_ratio << "\n"
+       << "\t\tRemove range: " << opt.remove_range_ratio << "\n"
+       << "\t\tSeek: " << opt.seek_ratio << "\n"
        << "\t\tFalse access: " << std::boolalpha << opt.negative_access;
     return os;
 }
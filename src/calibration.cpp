@@ -0,0 +1,376 @@
+#include "calibration.hpp"
+#include "cpu_topology.hpp"
+#include "stopwatch.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <omp.h>
+#include <random>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace PiBench
+{
+
+namespace
+{
+/// Field of calibration_t as saved, 'required' if always measured.
+struct field_t
+{
+    const char* name;
+    double calibration_t::* member;
+    bool required;
+};
+
+/// Fields of calibration_t, in the order they are saved.
+const field_t FIELDS[] = {
+    {"l1_bytes", &calibration_t::l1_bytes, true},
+    {"l2_bytes", &calibration_t::l2_bytes, true},
+    {"llc_bytes", &calibration_t::llc_bytes, true},
+    {"dram_bytes", &calibration_t::dram_bytes, true},
+    {"l1_ns", &calibration_t::l1_ns, true},
+    {"l2_ns", &calibration_t::l2_ns, true},
+    {"llc_ns", &calibration_t::llc_ns, true},
+    {"dram_ns", &calibration_t::dram_ns, true},
+    {"remote_dram_ns", &calibration_t::remote_dram_ns, false},
+    {"read_gbs", &calibration_t::read_gbs, true},
+    {"write_gbs", &calibration_t::write_gbs, true},
+    {"cas_mops_single", &calibration_t::cas_mops_single, true},
+    {"cas_mops_contended", &calibration_t::cas_mops_contended, true},
+    {"cas_threads", &calibration_t::cas_threads, true},
+    {"clock_ns", &calibration_t::clock_ns, false},
+    {"tsc_ns", &calibration_t::tsc_ns, false},
+    {"pool_read_ns", &calibration_t::pool_read_ns, false},
+    {"pool_write_ns", &calibration_t::pool_write_ns, false},
+    {"pool_msync_ns", &calibration_t::pool_msync_ns, false},
+};
+
+constexpr size_t CACHE_LINE = 64;
+constexpr uint64_t CHASE_LOADS = 1ULL << 22;
+
+/// Node of a pointer chasing chain, one per cache line.
+struct alignas(CACHE_LINE) line_t
+{
+    line_t* next;
+    char padding[CACHE_LINE - sizeof(line_t*)];
+};
+
+/// Link 'n' lines in a single cycle visiting them in random order.
+void build_chain(line_t* lines, size_t n)
+{
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(1729));
+    for (size_t i = 0; i < n; ++i)
+        lines[order[i]].next = &lines[order[(i + 1) % n]];
+}
+
+/// Average latency in nanoseconds of a dependent load along the chain.
+double chase(line_t* start, size_t n)
+{
+    line_t* p = start;
+    for (size_t i = 0; i < n; ++i)
+        p = p->next;
+
+    stopwatch_t sw;
+    sw.start();
+    for (uint64_t i = 0; i < CHASE_LOADS; ++i)
+        p = p->next;
+    auto elapsed = sw.elapsed<std::chrono::nanoseconds>();
+
+    asm volatile("" : : "r"(p) : "memory");
+    return elapsed / CHASE_LOADS;
+}
+
+/// Run 'f' on a thread pinned to 'cpu' (not pinned if negative).
+template <typename F>
+void run_on(int64_t cpu, F f)
+{
+    std::thread t([cpu, &f]() {
+        if (cpu >= 0)
+            topology::pin_thread(cpu);
+        f();
+    });
+    t.join();
+}
+
+/**
+ * @brief Pointer chasing latency over a working set of 'bytes'.
+ *
+ * Memory is first touched on 'alloc_cpu', so that on NUMA systems pages are
+ * allocated on its node, and chased from 'run_cpu'.
+ */
+double chase_latency(size_t bytes, int64_t alloc_cpu, int64_t run_cpu)
+{
+    size_t n = std::max<size_t>(bytes / CACHE_LINE, 2);
+    auto lines = static_cast<line_t*>(std::aligned_alloc(CACHE_LINE, n * CACHE_LINE));
+    if (lines == nullptr)
+        return 0;
+
+    double ns = 0;
+    run_on(alloc_cpu, [&]() { build_chain(lines, n); });
+    run_on(run_cpu, [&]() { ns = chase(lines, n); });
+
+    std::free(lines);
+    return ns;
+}
+
+/// Measure pool device latencies on a scratch file next to 'pool_path'.
+void calibrate_pool(const std::string& pool_path, calibration_t& c)
+{
+    constexpr size_t FILE_SZ = 64ULL << 20;
+    constexpr size_t PAGE = 4096;
+    std::string path = pool_path + ".calibration";
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, FILE_SZ) != 0)
+    {
+        std::cout << "Could not create calibration file " << path << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    void* addr = mmap(nullptr, FILE_SZ, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        std::cout << "Could not map calibration file " << path << std::endl;
+        close(fd);
+        unlink(path.c_str());
+        return;
+    }
+
+    auto lines = static_cast<line_t*>(addr);
+    const size_t n = FILE_SZ / CACHE_LINE;
+    build_chain(lines, n);
+    msync(addr, FILE_SZ, MS_SYNC);
+    c.pool_read_ns = chase(lines, n);
+
+    std::mt19937_64 rnd(1729);
+    std::uniform_int_distribution<size_t> line_dist(0, n - 1);
+    constexpr size_t WRITES = 1 << 20;
+    stopwatch_t sw;
+    sw.start();
+    for (size_t i = 0; i < WRITES; ++i)
+    {
+        auto l = &lines[line_dist(rnd)];
+        l->padding[0] = static_cast<char>(i);
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_clflush(l);
+        _mm_sfence();
+#endif
+    }
+    c.pool_write_ns = sw.elapsed<std::chrono::nanoseconds>() / WRITES;
+
+    std::uniform_int_distribution<size_t> page_dist(0, FILE_SZ / PAGE - 1);
+    constexpr size_t SYNCS = 1000;
+    sw.start();
+    for (size_t i = 0; i < SYNCS; ++i)
+    {
+        auto page = static_cast<char*>(addr) + page_dist(rnd) * PAGE;
+        page[0] = static_cast<char>(i);
+        msync(page, PAGE, MS_SYNC);
+    }
+    c.pool_msync_ns = sw.elapsed<std::chrono::nanoseconds>() / SYNCS;
+
+    munmap(addr, FILE_SZ);
+    close(fd);
+    unlink(path.c_str());
+}
+
+/// Compare-and-swap throughput of 'threads' threads on a single cache line.
+double cas_throughput(uint32_t threads)
+{
+    constexpr uint64_t CAS_PER_THREAD = 1 << 20;
+    alignas(CACHE_LINE) std::atomic<uint64_t> word(0);
+
+    stopwatch_t sw;
+    sw.start();
+    #pragma omp parallel num_threads(threads)
+    {
+        for (uint64_t i = 0; i < CAS_PER_THREAD; ++i)
+        {
+            auto v = word.load(std::memory_order_relaxed);
+            while (!word.compare_exchange_weak(v, v + 1))
+                ;
+        }
+    }
+    auto elapsed = sw.elapsed<std::chrono::microseconds>();
+    return threads * CAS_PER_THREAD / elapsed;
+}
+} // namespace
+
+bool calibration_t::save(const std::string& path) const
+{
+    std::ofstream f(path, std::ofstream::out | std::ofstream::trunc);
+    if (!f.good())
+        return false;
+    for (auto& field : FIELDS)
+        f << field.name << " " << this->*field.member << "\n";
+    return f.good();
+}
+
+bool calibration_t::load(const std::string& path, std::string& error)
+{
+    std::ifstream f(path, std::ifstream::in);
+    if (!f.good())
+    {
+        error = "cannot open file";
+        return false;
+    }
+
+    calibration_t c;
+    bool seen[std::size(FIELDS)] = {};
+    std::string name;
+    while (f >> name)
+    {
+        auto field = std::find_if(std::begin(FIELDS), std::end(FIELDS), [&](const field_t& fd) { return name == fd.name; });
+        if (field == std::end(FIELDS))
+        {
+            error = "measurement '" + name + "' is not known";
+            return false;
+        }
+
+        auto i = field - std::begin(FIELDS);
+        if (seen[i])
+        {
+            error = "measurement '" + name + "' is repeated";
+            return false;
+        }
+        seen[i] = true;
+
+        double value;
+        if (!(f >> value) || !std::isfinite(value))
+        {
+            error = "measurement '" + name + "' is not a number";
+            return false;
+        }
+        if (field->required ? value <= 0 : value < 0)
+        {
+            error = "measurement '" + name + "' is " + std::to_string(value) + (field->required ? ", but must be positive" : ", but must not be negative");
+            return false;
+        }
+        c.*field->member = value;
+    }
+
+    for (size_t i = 0; i < std::size(FIELDS); ++i)
+    {
+        if (FIELDS[i].required && !seen[i])
+        {
+            error = std::string("measurement '") + FIELDS[i].name + "' is missing";
+            return false;
+        }
+    }
+
+    *this = c;
+    return true;
+}
+
+calibration_t calibrate(uint32_t num_threads, const std::string& pool_path)
+{
+    calibration_t c;
+    auto nodes = topology::numa_nodes();
+    int64_t local_cpu = nodes[0].empty() ? -1 : nodes[0][0];
+
+    // Working sets fit comfortably into each level, DRAM is far beyond LLC.
+    c.l1_bytes = topology::cache_size(1) ? topology::cache_size(1) / 2 : 16 << 10;
+    c.l2_bytes = topology::cache_size(2) ? topology::cache_size(2) / 2 : 512 << 10;
+    c.llc_bytes = topology::cache_size(3) ? topology::cache_size(3) / 2 : 8 << 20;
+    c.dram_bytes = std::max<double>(256 << 20, c.llc_bytes * 16);
+
+    c.l1_ns = chase_latency(c.l1_bytes, local_cpu, local_cpu);
+    c.l2_ns = chase_latency(c.l2_bytes, local_cpu, local_cpu);
+    c.llc_ns = chase_latency(c.llc_bytes, local_cpu, local_cpu);
+    c.dram_ns = chase_latency(c.dram_bytes, local_cpu, local_cpu);
+    if (nodes.size() > 1 && !nodes[1].empty())
+        c.remote_dram_ns = chase_latency(c.dram_bytes, nodes[1][0], local_cpu);
+
+    // Streaming bandwidth over the DRAM working set, best of three.
+    size_t words = static_cast<size_t>(c.dram_bytes) / sizeof(uint64_t);
+    std::vector<uint64_t> buf(words);
+    #pragma omp parallel for schedule(static) num_threads(num_threads)
+    for (size_t i = 0; i < words; ++i)
+        buf[i] = i;
+
+    for (int rep = 0; rep < 3; ++rep)
+    {
+        uint64_t sum = 0;
+        stopwatch_t sw;
+        sw.start();
+        #pragma omp parallel for schedule(static) reduction(+:sum) num_threads(num_threads)
+        for (size_t i = 0; i < words; ++i)
+            sum += buf[i];
+        c.read_gbs = std::max<double>(c.read_gbs, c.dram_bytes / sw.elapsed<std::chrono::nanoseconds>());
+        asm volatile("" : : "r"(sum) : "memory");
+
+        sw.start();
+        #pragma omp parallel num_threads(num_threads)
+        {
+            size_t chunk = (words + omp_get_num_threads() - 1) / omp_get_num_threads();
+            size_t begin = std::min(words, chunk * omp_get_thread_num());
+            size_t end = std::min(words, begin + chunk);
+            memset(buf.data() + begin, rep, (end - begin) * sizeof(uint64_t));
+        }
+        c.write_gbs = std::max<double>(c.write_gbs, c.dram_bytes / sw.elapsed<std::chrono::nanoseconds>());
+    }
+    std::vector<uint64_t>().swap(buf);
+
+    c.cas_threads = std::max<uint32_t>(num_threads, 2);
+    c.cas_mops_single = cas_throughput(1);
+    c.cas_mops_contended = cas_throughput(c.cas_threads);
+
+    constexpr uint64_t TIMER_CALLS = 1 << 22;
+    stopwatch_t sw;
+    sw.start();
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < TIMER_CALLS; ++i)
+        acc += std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    c.clock_ns = sw.elapsed<std::chrono::nanoseconds>() / TIMER_CALLS;
+
+    sw.start();
+    for (uint64_t i = 0; i < TIMER_CALLS; ++i)
+        acc += utils::tsc();
+    c.tsc_ns = sw.elapsed<std::chrono::nanoseconds>() / TIMER_CALLS;
+    asm volatile("" : : "r"(acc) : "memory");
+
+    if (!pool_path.empty())
+        calibrate_pool(pool_path, c);
+
+    return c;
+}
+} // namespace PiBench
+
+namespace std
+{
+std::ostream& operator<<(std::ostream& os, const PiBench::calibration_t& c)
+{
+    os << "Calibration:"
+       << "\n"
+       << "\tL1 latency (" << c.l1_bytes / 1024 << " KB): " << c.l1_ns << " ns\n"
+       << "\tL2 latency (" << c.l2_bytes / 1024 << " KB): " << c.l2_ns << " ns\n"
+       << "\tLLC latency (" << c.llc_bytes / 1024 << " KB): " << c.llc_ns << " ns\n"
+       << "\tDRAM latency (" << c.dram_bytes / 1024 << " KB): " << c.dram_ns << " ns\n"
+       << "\tRemote DRAM latency: " << c.remote_dram_ns << " ns\n"
+       << "\tRead bandwidth: " << c.read_gbs << " GB/s\n"
+       << "\tWrite bandwidth: " << c.write_gbs << " GB/s\n"
+       << "\tCAS throughput (1 thread): " << c.cas_mops_single << " Mops/s\n"
+       << "\tCAS throughput (" << c.cas_threads << " threads): " << c.cas_mops_contended << " Mops/s\n"
+       << "\tClock cost: " << c.clock_ns << " ns\n"
+       << "\tTSC cost: " << c.tsc_ns << " ns\n"
+       << "\tPool read latency: " << c.pool_read_ns << " ns\n"
+       << "\tPool write+flush latency: " << c.pool_write_ns << " ns\n"
+       << "\tPool msync latency: " << c.pool_msync_ns << " ns";
+    return os;
+}
+} // namespace std
@@ -0,0 +1,134 @@
+#include "cpu_topology.hpp"
+
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+namespace PiBench
+{
+namespace topology
+{
+
+namespace
+{
+/// Read the first line of a sysfs file, empty if it does not exist.
+std::string read_line(const std::string& path)
+{
+    std::ifstream f(path, std::ifstream::in);
+    std::string line;
+    if (f.good())
+        std::getline(f, line);
+    return line;
+}
+} // namespace
+
+std::vector<uint32_t> parse_cpu_list(const std::string& list)
+{
+    std::vector<uint32_t> cpus;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        auto end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.size();
+
+        auto item = list.substr(pos, end - pos);
+        auto dash = item.find('-');
+        try
+        {
+            if (dash == std::string::npos)
+            {
+                cpus.push_back(std::stoul(item));
+            }
+            else
+            {
+                uint32_t first = std::stoul(item.substr(0, dash));
+                uint32_t last = std::stoul(item.substr(dash + 1));
+                for (uint32_t c = first; c <= last; ++c)
+                    cpus.push_back(c);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Skip malformed items (e.g. empty lists).
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+std::vector<std::vector<uint32_t>> numa_nodes()
+{
+    std::vector<std::vector<uint32_t>> nodes;
+    for (uint32_t n = 0;; ++n)
+    {
+        auto list = read_line("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+        if (list.empty())
+            break;
+        nodes.push_back(parse_cpu_list(list));
+    }
+
+    if (nodes.empty())
+    {
+        std::vector<uint32_t> all;
+        for (uint32_t c = 0; c < std::thread::hardware_concurrency(); ++c)
+            all.push_back(c);
+        nodes.push_back(all);
+    }
+    return nodes;
+}
+
+std::vector<uint32_t> smt_siblings(uint32_t cpu)
+{
+    auto list = read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+    std::vector<uint32_t> siblings;
+    for (auto c : parse_cpu_list(list))
+        if (c != cpu)
+            siblings.push_back(c);
+    return siblings;
+}
+
+uint64_t cache_size(uint32_t level)
+{
+    for (uint32_t i = 0;; ++i)
+    {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+        auto lvl = read_line(dir + "level");
+        if (lvl.empty())
+            return 0;
+
+        auto type = read_line(dir + "type");
+        if (std::stoul(lvl) != level || type == "Instruction")
+            continue;
+
+        // Size is given as e.g. "32K" or "16384K".
+        auto size = read_line(dir + "size");
+        if (size.empty())
+            return 0;
+        uint64_t bytes = std::stoull(size);
+        switch (size.back())
+        {
+            case 'K': return bytes << 10;
+            case 'M': return bytes << 20;
+            case 'G': return bytes << 30;
+            default: return bytes;
+        }
+    }
+}
+
+bool pin_thread(uint32_t cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+uint32_t current_cpu()
+{
+    auto cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+} // namespace topology
+} // namespace PiBench
@@ -0,0 +1,126 @@
+#include "expiry.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace PiBench
+{
+
+namespace
+{
+/// Slots of the ring of each producer.
+constexpr size_t RING_CAPACITY = 1 << 16;
+
+/// Records moved from a ring to the heap at once.
+constexpr size_t DRAIN_BATCH = 256;
+
+/// Sleep of the expiry thread when nothing expired.
+constexpr auto IDLE_SLEEP = std::chrono::microseconds(50);
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+expiry_t::expiry_t(tree_api* tree, const key_generator_t& keys, uint32_t producers, uint64_t max_id)
+    : tree_(tree),
+      keys_(keys),
+      max_id_(max_id),
+      expired_(std::make_unique<std::atomic<uint64_t>[]>(max_id / 64 + 1)),
+      stop_(false),
+      stalls_(0)
+{
+    for (uint32_t p = 0; p < producers; ++p)
+        rings_.push_back(std::make_unique<spsc_ring_t<entry_t>>(RING_CAPACITY));
+    for (uint64_t i = 0; i < max_id / 64 + 1; ++i)
+        expired_[i].store(0, std::memory_order_relaxed);
+}
+
+expiry_t::~expiry_t()
+{
+    stop();
+}
+
+void expiry_t::start()
+{
+    stop_.store(false);
+    thread_ = std::thread(&expiry_t::work, this);
+}
+
+void expiry_t::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    stop_.store(true);
+    thread_.join();
+
+    drain();
+    pending_ = heap_.size();
+    std::sort(lag_ns_.begin(), lag_ns_.end());
+}
+
+void expiry_t::add(uint32_t producer, uint64_t id, int64_t ttl_ns) noexcept
+{
+    entry_t e{now_ns() + ttl_ns, id};
+    auto& ring = *rings_[producer];
+    if (ring.try_push(e))
+        return;
+
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    while (!ring.try_push(e))
+        std::this_thread::yield();
+}
+
+bool expiry_t::drain() noexcept
+{
+    entry_t batch[DRAIN_BATCH];
+    bool any = false;
+    for (auto& ring : rings_)
+    {
+        size_t n;
+        while ((n = ring->pop_batch(batch, DRAIN_BATCH)) > 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+                heap_.push(batch[i]);
+            registered_ += n;
+            any = true;
+        }
+    }
+    return any;
+}
+
+void expiry_t::work()
+{
+    char key[key_generator_t::KEY_MAX];
+    while (!stop_.load(std::memory_order_relaxed))
+    {
+        bool busy = drain();
+
+        // Removals are bounded per pass, so rings keep being drained.
+        auto now = now_ns();
+        for (size_t i = 0; i < DRAIN_BATCH && !heap_.empty() && heap_.top().deadline_ns <= now; ++i)
+        {
+            auto e = heap_.top();
+            heap_.pop();
+
+            // Marked first, so operations missing the record from now on are expected.
+            if (e.id < max_id_)
+                expired_[e.id >> 6].fetch_or(1ULL << (e.id & 63), std::memory_order_release);
+
+            keys_.key_of(e.id, key);
+            if (tree_->remove(key, keys_.size()))
+                ++removed_;
+            else
+                ++failed_;
+            lag_ns_.push_back(now_ns() - e.deadline_ns);
+            busy = true;
+        }
+
+        if (!busy)
+            std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+}
+} // namespace PiBench
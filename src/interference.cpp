@@ -0,0 +1,175 @@
+#include "interference.hpp"
+#include "cpu_topology.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace PiBench
+{
+
+namespace
+{
+/// Cache line size in Bytes.
+constexpr uint64_t LINE = 64;
+
+/// Words per cache line.
+constexpr uint64_t LINE_WORDS = LINE / sizeof(uint64_t);
+
+/// Bytes accessed between checks of the stop flag.
+constexpr uint64_t CHUNK = 1 << 20;
+} // namespace
+
+bool parse_interference_kind(const std::string& name, interference_kind_t& kind)
+{
+    std::string n = name;
+    std::transform(n.begin(), n.end(), n.begin(), ::tolower);
+    if (n == "stream_read")
+        kind = interference_kind_t::STREAM_READ;
+    else if (n == "stream_write")
+        kind = interference_kind_t::STREAM_WRITE;
+    else if (n == "random")
+        kind = interference_kind_t::RANDOM;
+    else if (n == "chase")
+        kind = interference_kind_t::POINTER_CHASE;
+    else
+        return false;
+    return true;
+}
+
+interference_t::interference_t(interference_kind_t kind, uint64_t footprint)
+    : kind_(kind),
+      footprint_(std::max(footprint, CHUNK)),
+      stop_(false),
+      ready_(0),
+      bytes_(0),
+      sink_(0)
+{
+}
+
+interference_t::~interference_t()
+{
+    stop();
+}
+
+void interference_t::start(const std::vector<uint32_t>& cpus)
+{
+    stop_.store(false);
+    ready_.store(0);
+    bytes_.store(0);
+
+    for (auto cpu : cpus)
+        threads_.emplace_back(&interference_t::work, this, cpu);
+
+    // Buffer initialization must not overlap with the measured workload.
+    while (ready_.load() < cpus.size())
+        std::this_thread::yield();
+
+    start_ = std::chrono::high_resolution_clock::now();
+}
+
+void interference_t::stop()
+{
+    if (threads_.empty())
+        return;
+
+    stop_.store(true);
+    for (auto& t : threads_)
+        t.join();
+    threads_.clear();
+    stop_time_ = std::chrono::high_resolution_clock::now();
+}
+
+double interference_t::bandwidth_gbs() const noexcept
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time_ - start_).count();
+    return ns > 0 ? static_cast<double>(bytes_.load()) / ns : 0.0;
+}
+
+void interference_t::work(uint32_t cpu)
+{
+    topology::pin_thread(cpu);
+
+    const uint64_t lines = footprint_ / LINE;
+    std::vector<uint64_t> buf(lines * LINE_WORDS);
+    std::mt19937_64 rnd(cpu + 1);
+
+    if (kind_ == interference_kind_t::POINTER_CHASE)
+    {
+        // Random cyclic permutation of cache lines (Sattolo), so hardware
+        // prefetchers cannot predict the next line.
+        std::vector<uint64_t> order(lines);
+        std::iota(order.begin(), order.end(), 0);
+        for (uint64_t i = lines - 1; i > 0; --i)
+            std::swap(order[i], order[rnd() % i]);
+        for (uint64_t i = 0; i < lines; ++i)
+            buf[order[i] * LINE_WORDS] = order[(i + 1) % lines];
+    }
+
+    ready_.fetch_add(1);
+
+    uint64_t bytes = 0;
+    uint64_t sink = 0;
+    uint64_t pos = 0;
+    uint64_t line = 0;
+    uint64_t x = rnd() | 1;
+    while (!stop_.load(std::memory_order_relaxed))
+    {
+        switch (kind_)
+        {
+            case interference_kind_t::STREAM_READ:
+                for (uint64_t i = pos; i < pos + CHUNK / sizeof(uint64_t); ++i)
+                    sink += buf[i];
+                break;
+
+            case interference_kind_t::STREAM_WRITE:
+                for (uint64_t i = pos; i < pos + CHUNK / sizeof(uint64_t); ++i)
+                    buf[i] = i + bytes;
+                break;
+
+            case interference_kind_t::RANDOM:
+                for (uint64_t i = 0; i < CHUNK / LINE; ++i)
+                {
+                    // xorshift64
+                    x ^= x << 13;
+                    x ^= x >> 7;
+                    x ^= x << 17;
+                    ++buf[(x % lines) * LINE_WORDS];
+                }
+                break;
+
+            case interference_kind_t::POINTER_CHASE:
+                for (uint64_t i = 0; i < CHUNK / LINE; ++i)
+                    line = buf[line * LINE_WORDS];
+                break;
+        }
+        bytes += CHUNK;
+        pos += CHUNK / sizeof(uint64_t);
+        if (pos + CHUNK / sizeof(uint64_t) > buf.size())
+            pos = 0;
+    }
+
+    bytes_.fetch_add(bytes);
+    sink_.fetch_add(sink + line);
+}
+} // namespace PiBench
+
+namespace std
+{
+std::ostream& operator<<(std::ostream& os, const PiBench::interference_kind_t& kind)
+{
+    switch (kind)
+    {
+    case PiBench::interference_kind_t::STREAM_READ:
+        return os << "stream_read";
+    case PiBench::interference_kind_t::STREAM_WRITE:
+        return os << "stream_write";
+    case PiBench::interference_kind_t::RANDOM:
+        return os << "random";
+    case PiBench::interference_kind_t::POINTER_CHASE:
+        return os << "chase";
+    default:
+        return os << static_cast<uint8_t>(kind);
+    }
+}
+} // namespace std
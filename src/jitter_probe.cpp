@@ -0,0 +1,72 @@
+#include "jitter_probe.hpp"
+#include "cpu_topology.hpp"
+
+#include <algorithm>
+#include <functional> // std::ref
+
+namespace PiBench
+{
+
+jitter_probe_t::jitter_probe_t(uint64_t threshold_ns)
+    : threshold_ns_(threshold_ns),
+      stop_(false)
+{
+}
+
+jitter_probe_t::~jitter_probe_t()
+{
+    stop();
+}
+
+void jitter_probe_t::start(const std::vector<uint32_t>& cpus)
+{
+    stop_.store(false);
+    cpus_ = cpus;
+    events_.clear();
+
+    // Preallocate so that recording never allocates (and causes gaps itself).
+    probe_events_.assign(cpus.size(), {});
+    for (auto& e : probe_events_)
+        e.reserve(MAX_EVENTS);
+
+    for (size_t i = 0; i < cpus.size(); ++i)
+        threads_.emplace_back(&jitter_probe_t::probe, this, cpus[i], std::ref(probe_events_[i]));
+}
+
+void jitter_probe_t::stop()
+{
+    if (threads_.empty())
+        return;
+
+    stop_.store(true);
+    for (auto& t : threads_)
+        t.join();
+    threads_.clear();
+
+    for (auto& e : probe_events_)
+        events_.insert(events_.end(), e.begin(), e.end());
+    probe_events_.clear();
+
+    std::sort(events_.begin(), events_.end(), [](const jitter_event_t& a, const jitter_event_t& b) {
+        return a.start < b.start;
+    });
+}
+
+void jitter_probe_t::probe(uint32_t cpu, std::vector<jitter_event_t>& events)
+{
+    topology::pin_thread(cpu);
+
+    const std::chrono::nanoseconds threshold(threshold_ns_);
+    auto prev = std::chrono::high_resolution_clock::now();
+    while (!stop_.load(std::memory_order_relaxed))
+    {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - prev > threshold && events.size() < MAX_EVENTS)
+        {
+            events.push_back({prev, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - prev).count()), cpu});
+        }
+        prev = now;
+    }
+}
+} // namespace PiBench
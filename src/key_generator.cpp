@@ -8,6 +8,8 @@ thread_local std::default_random_engine key_generator_t::generator_;
 thread_local uint32_t key_generator_t::seed_;
 thread_local char key_generator_t::buf_[KEY_MAX];
 thread_local uint64_t key_generator_t::current_id_ = 1;
+thread_local uint64_t key_generator_t::last_id_ = 0;
+thread_local size_t operation_key_generator_t::selected_ = 0;
 
 key_generator_t::key_generator_t(size_t N, size_t size, uint16_t thread_num, bool tid_prefix, const std::string& prefix)
     : N_(N),
@@ -26,30 +28,49 @@ key_generator_t::key_generator_t(size_t N, size_t size, uint16_t thread_num, boo
 
 const char* key_generator_t::next(bool negative_access, bool in_sequence)
 {
+    // buf_ is per thread, workers may not be the thread that constructed the generator.
+    memcpy(buf_, prefix_.c_str(), prefix_.size());
     char* ptr = &buf_[prefix_.size()];
 
     uint64_t id = in_sequence ? current_id_++ : (negative_access ? next_id() + current_id_ : next_id());
+    last_id_ = id;
 
     bits_shift(ptr,id);
 
     return buf_;
 }
 
+uint64_t key_generator_t::next_u64(bool negative_access, bool in_sequence)
+{
+    uint64_t id = in_sequence ? current_id_++ : (negative_access ? next_id() + current_id_ : next_id());
+    last_id_ = id;
+
+    return utils::multiplicative_hash<uint64_t>(id);
+}
+
 const char* key_generator_t::next(uint8_t tid, bool negative_access, bool in_sequence)
 {
     // 1 Byte after prefix is tid
+    memcpy(buf_, prefix_.c_str(), prefix_.size());
     char *ptr = &buf_[prefix_.size()];
     memcpy(ptr,&tid,1);
     ptr = &buf_[prefix_.size()+1];
 
     uint64_t id = in_sequence ? thread_stat[tid]++ : (negative_access ? next_id(thread_stat[tid] - 1) + thread_stat[tid] : next_id(thread_stat[tid] - 1)) ;
+    last_id_ = id;
 
     bits_shift(ptr,id);
 
     return buf_;
 }
 
-void key_generator_t::bits_shift(char *buf_ptr, uint64_t id)
+void key_generator_t::key_of(uint64_t id, char* dst) const
+{
+    memcpy(dst, prefix_.c_str(), prefix_.size());
+    bits_shift(dst + prefix_.size(), id);
+}
+
+void key_generator_t::bits_shift(char *buf_ptr, uint64_t id) const
 {
     uint64_t hashed_id = utils::multiplicative_hash<uint64_t>(id);
     if (size_ < sizeof(hashed_id))
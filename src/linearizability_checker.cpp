@@ -0,0 +1,260 @@
+#include "linearizability_checker.hpp"
+
+#include <algorithm>
+#include <omp.h>
+#include <unordered_set>
+
+namespace PiBench
+{
+
+namespace
+{
+/// Value held by the register modeling a single key.
+struct key_state_t
+{
+    bool present;
+    uint64_t value;
+};
+
+/**
+ * @brief Apply operation 'e' to register 's'.
+ *
+ * @return true if the tree response is consistent with 's', in which case
+ *         'out' holds the state after the operation.
+ */
+bool apply(const history_event_t& e, const key_state_t& s, key_state_t& out)
+{
+    out = s;
+    switch (e.op)
+    {
+        case history_op_t::FIND:
+            return e.result ? (s.present && s.value == e.value) : !s.present;
+
+        case history_op_t::INSERT:
+            if (e.result == s.present)
+                return false;
+            if (e.result)
+                out = {true, e.value};
+            return true;
+
+        case history_op_t::UPDATE:
+            if (e.result != s.present)
+                return false;
+            if (e.result)
+                out.value = e.value;
+            return true;
+
+        case history_op_t::REMOVE:
+            if (e.result != s.present)
+                return false;
+            out.present = false;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/// Configuration of the search: set of linearized operations plus state.
+struct config_t
+{
+    std::vector<uint64_t> linearized;
+    key_state_t state;
+
+    bool operator==(const config_t& o) const
+    {
+        return state.present == o.state.present
+            && (!state.present || state.value == o.state.value)
+            && linearized == o.linearized;
+    }
+};
+
+struct config_hash_t
+{
+    size_t operator()(const config_t& c) const
+    {
+        uint64_t h = c.state.present ? utils::multiplicative_hash<uint64_t>(c.state.value + 1) : 0;
+        for (auto w : c.linearized)
+            h = utils::multiplicative_hash<uint64_t>(h ^ w) + 0x9e3779b97f4a7c15ull;
+        return h;
+    }
+};
+} // namespace
+
+linearizability_checker_t::linearizability_checker_t(initial_state_fn initial, uint32_t num_threads, uint64_t max_steps)
+    : initial_(initial),
+      num_threads_(std::max<uint32_t>(num_threads, 1)),
+      max_steps_(max_steps)
+{
+}
+
+bool linearizability_checker_t::check_key(std::vector<history_event_t>& events, bool present, uint64_t value, uint64_t& steps) const
+{
+    const size_t n = events.size();
+    steps = 0;
+
+    // Entries 1..2n are calls and returns ordered by time, 0 and 2n+1 are
+    // head and tail sentinels of a doubly linked list.
+    struct entry_t
+    {
+        uint64_t time;
+        uint32_t id;
+        bool call;
+    };
+    std::vector<entry_t> entries;
+    entries.reserve(2 * n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        entries.push_back({events[i].invoke, i, true});
+        entries.push_back({events[i].response, i, false});
+    }
+    // On ties calls go first, which only widens the allowed orderings.
+    std::sort(entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) {
+        return a.time < b.time || (a.time == b.time && a.call && !b.call);
+    });
+
+    const size_t HEAD = 0, TAIL = 2 * n + 1;
+    std::vector<size_t> prev(2 * n + 2), next(2 * n + 2), match(2 * n + 2), call_of(n);
+    for (size_t i = 0; i <= TAIL; ++i)
+    {
+        prev[i] = i == HEAD ? HEAD : i - 1;
+        next[i] = i == TAIL ? TAIL : i + 1;
+    }
+    for (size_t i = 1; i <= 2 * n; ++i)
+        if (entries[i - 1].call)
+            call_of[entries[i - 1].id] = i;
+    for (size_t i = 1; i <= 2 * n; ++i)
+        if (!entries[i - 1].call)
+            match[call_of[entries[i - 1].id]] = i;
+
+    auto unlink = [&](size_t e) {
+        next[prev[e]] = next[e];
+        prev[next[e]] = prev[e];
+    };
+    auto relink = [&](size_t e) {
+        next[prev[e]] = e;
+        prev[next[e]] = e;
+    };
+
+    config_t current{std::vector<uint64_t>((n + 63) / 64, 0), {present, value}};
+    std::unordered_set<config_t, config_hash_t> cache;
+    std::vector<std::pair<size_t, key_state_t>> stack;
+
+    size_t entry = next[HEAD];
+    while (next[HEAD] != TAIL)
+    {
+        if (++steps > max_steps_)
+            return false;
+
+        const auto& ent = entries[entry - 1];
+        if (ent.call)
+        {
+            key_state_t after;
+            if (apply(events[ent.id], current.state, after))
+            {
+                auto before = current.state;
+                current.linearized[ent.id / 64] |= 1ull << (ent.id % 64);
+                current.state = after;
+                if (cache.insert(current).second)
+                {
+                    stack.emplace_back(entry, before);
+                    unlink(entry);
+                    unlink(match[entry]);
+                    entry = next[HEAD];
+                    continue;
+                }
+                current.linearized[ent.id / 64] &= ~(1ull << (ent.id % 64));
+                current.state = before;
+            }
+            entry = next[entry];
+        }
+        else
+        {
+            // Reached the response of an operation that could not be
+            // linearized before it returned: backtrack.
+            if (stack.empty())
+                return false;
+
+            auto [e, s] = stack.back();
+            stack.pop_back();
+            auto id = entries[e - 1].id;
+            current.linearized[id / 64] &= ~(1ull << (id % 64));
+            current.state = s;
+            relink(match[e]);
+            relink(e);
+            entry = next[e];
+        }
+    }
+    return true;
+}
+
+linearizability_checker_t::result_t linearizability_checker_t::check(const std::vector<const std::vector<history_event_t>*>& histories) const
+{
+    result_t result;
+
+    // Scatter events into partitions by key so that every key is entirely
+    // contained in exactly one partition.
+    const size_t num_partitions = num_threads_ * 16;
+    std::vector<std::vector<std::vector<history_event_t>>> scattered(histories.size());
+
+    #pragma omp parallel for schedule(dynamic) num_threads(num_threads_)
+    for (size_t h = 0; h < histories.size(); ++h)
+    {
+        scattered[h].resize(num_partitions);
+        for (const auto& e : *histories[h])
+            scattered[h][utils::multiplicative_hash<uint64_t>(e.key) % num_partitions].push_back(e);
+    }
+
+    #pragma omp parallel for schedule(dynamic) num_threads(num_threads_)
+    for (size_t p = 0; p < num_partitions; ++p)
+    {
+        std::vector<history_event_t> events;
+        for (auto& s : scattered)
+        {
+            events.insert(events.end(), s[p].begin(), s[p].end());
+            std::vector<history_event_t>().swap(s[p]);
+        }
+
+        std::sort(events.begin(), events.end(), [](const history_event_t& a, const history_event_t& b) {
+            return a.key < b.key || (a.key == b.key && a.invoke < b.invoke);
+        });
+
+        uint64_t keys = 0;
+        std::vector<uint64_t> violations;
+        std::vector<uint64_t> inconclusive;
+        std::vector<history_event_t> key_events;
+        for (size_t begin = 0; begin < events.size();)
+        {
+            size_t end = begin;
+            while (end < events.size() && events[end].key == events[begin].key)
+                ++end;
+
+            key_events.assign(events.begin() + begin, events.begin() + end);
+            uint64_t value = 0;
+            bool present = initial_(events[begin].key, value);
+            uint64_t steps;
+            if (!check_key(key_events, present, value, steps))
+            {
+                if (steps > max_steps_)
+                    inconclusive.push_back(events[begin].key);
+                else
+                    violations.push_back(events[begin].key);
+            }
+            ++keys;
+            begin = end;
+        }
+
+        #pragma omp critical
+        {
+            result.keys += keys;
+            result.operations += events.size();
+            result.violations.insert(result.violations.end(), violations.begin(), violations.end());
+            result.inconclusive.insert(result.inconclusive.end(), inconclusive.begin(), inconclusive.end());
+        }
+    }
+
+    std::sort(result.violations.begin(), result.violations.end());
+    std::sort(result.inconclusive.begin(), result.inconclusive.end());
+    return result;
+}
+} // namespace PiBench
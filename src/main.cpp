@@ -1,6 +1,9 @@
 #include "tree_api.hpp"
 #include "benchmark.hpp"
 #include "library_loader.hpp"
+#include "multi_process.hpp"
+#include "calibration.hpp"
+#include "cpu_topology.hpp"
 #include "cxxopts.hpp"
 
 #include <iostream>
@@ -38,11 +41,44 @@ int main(int argc, char** argv)
             ("d,remove_ratio", "Ratio of remove operations", cxxopts::value<float>()->default_value(std::to_string(opt.remove_ratio)))
             ("s,scan_ratio", "Ratio of scan operations", cxxopts::value<float>()->default_value(std::to_string(opt.scan_ratio)))
             ("scan_size", "Number of records to be scanned.", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.scan_size)))
+            ("aggregate_ratio", "Ratio of range aggregate operations", cxxopts::value<float>()->default_value(std::to_string(opt.aggregate_ratio)))
+            ("aggregate_size", "Number of records in ranges of aggregate operations", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.aggregate_size)))
+            ("aggregate_fallback", "Aggregate ranges from scans even if the tree supports aggregates", cxxopts::value<bool>()->default_value((opt.aggregate_fallback ? "true" : "false")))
+            ("remove_range_ratio", "Ratio of range remove operations", cxxopts::value<float>()->default_value(std::to_string(opt.remove_range_ratio)))
+            ("remove_range_size", "Number of records in ranges of remove operations", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.remove_range_size)))
+            ("remove_range_fallback", "Remove ranges by scans and removes even if the tree supports range removes", cxxopts::value<bool>()->default_value((opt.remove_range_fallback ? "true" : "false")))
+            ("locality_run", "Number of consecutive records visited by reads and updates of a thread (disabled if 0)", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.locality_run)))
+            ("hints", "Repeat the run with reads and inserts starting from a per-thread hint", cxxopts::value<bool>()->default_value((opt.hints ? "true" : "false")))
+            ("seek_ratio", "Ratio of seek operations", cxxopts::value<float>()->default_value(std::to_string(opt.seek_ratio)))
+            ("seek_type", "Point query of seek operations [LOWER_BOUND | UPPER_BOUND | PREDECESSOR]", cxxopts::value<std::string>()->default_value("LOWER_BOUND"))
+            ("seek_gap_ratio", "Ratio of seek operations looking for a key not in the tree", cxxopts::value<float>()->default_value(std::to_string(opt.seek_gap_ratio)))
+            ("seek_fallback", "Seek with scans even if the tree supports seeks", cxxopts::value<bool>()->default_value((opt.seek_fallback ? "true" : "false")))
+            ("typed_keys", "Use integer entry points for 8-Byte keys and values if the tree supports them", cxxopts::value<bool>()->default_value((opt.typed_keys ? "true" : "false")))
+            ("transactions", "Run multi-key transactions instead of single operations", cxxopts::value<bool>()->default_value((opt.transactions ? "true" : "false")))
+            ("txn_min_keys", "Minimum number of keys accessed by a transaction", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.txn_min_keys)))
+            ("txn_max_keys", "Maximum number of keys accessed by a transaction", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.txn_max_keys)))
+            ("txn_write_ratio", "Ratio of keys of a transaction that are written", cxxopts::value<float>()->default_value(std::to_string(opt.txn_write_ratio)))
+            ("txn_hot_keys", "Number of hot records transactions contend on (disabled if 0)", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.txn_hot_keys)))
+            ("txn_hot_ratio", "Ratio of keys of a transaction drawn from the hot records", cxxopts::value<float>()->default_value(std::to_string(opt.txn_hot_ratio)))
+            ("duplicates", "Maximum number of records per key (multimap workload)", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.duplicates)))
+            ("duplicate_skew", "Zipfian skew of the number of records per key (uniform if 0)", cxxopts::value<float>()->default_value(std::to_string(opt.duplicate_skew)))
+            ("remove_duplicates", "Records of a key removed by a remove [one | all]", cxxopts::value<std::string>()->default_value("one"))
             ("negative_access","Generate keys not in the index",cxxopts::value<bool>()->default_value((opt.negative_access ? "true" : "false")))
             ("negative_access_rate"," Ratio of negative read/update operations",cxxopts::value<float>()->default_value(std::to_string(opt.negative_access_rate)))
+            ("growth_start", "Load incrementally, probing the tree at this number of records and each doubling", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.growth_start)))
+            ("probe_ops", "Number of lookups probing the tree at each checkpoint", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.probe_ops)))
+            ("memory_budget", "Insert records until the tree uses this memory (in Bytes)", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.memory_budget)))
+            ("memory_budget_source", "Memory compared to the budget [rss | tree]", cxxopts::value<std::string>()->default_value(opt.memory_budget_source))
+            ("aging_ops", "Number of records removed and reinserted or updated after load to age the tree", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.aging_ops)))
+            ("aging_batch", "Number of records removed before being reinserted by aging", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.aging_batch)))
+            ("aging_update_ratio", "Ratio of aging operations that update records", cxxopts::value<float>()->default_value(std::to_string(opt.aging_update_ratio)))
             ("sampling_ms", "Sampling window in milliseconds", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.sampling_ms)))
             ("distribution", "Key distribution to use", cxxopts::value<std::string>()->default_value("UNIFORM"))
             ("skew", "Key distribution skew factor to use", cxxopts::value<float>()->default_value(std::to_string(opt.key_skew)))
+            ("read_distribution", "Key distribution of reads, a mixture such as \"ZIPFIAN:0.99@0.8+UNIFORM@0.2\" (default: distribution)", cxxopts::value<std::string>()->default_value(""))
+            ("update_distribution", "Key distribution of updates (default: distribution)", cxxopts::value<std::string>()->default_value(""))
+            ("remove_distribution", "Key distribution of deletes (default: distribution)", cxxopts::value<std::string>()->default_value(""))
+            ("scan_distribution", "Key distribution of the start of scans, aggregates, range removes and seeks (default: distribution)", cxxopts::value<std::string>()->default_value(""))
             ("seed", "Seed for random generators", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.rnd_seed)))
             ("pcm", "Turn on Intel PCM", cxxopts::value<bool>()->default_value((opt.enable_pcm ? "true" : "false")))
             ("pool_path", "Path to persistent pool", cxxopts::value<std::string>()->default_value("\"" + tree_opt.pool_path + "\""))
@@ -51,6 +87,33 @@ int main(int argc, char** argv)
             ("latency_sampling", "Sample latency of requests", cxxopts::value<float>()->default_value(std::to_string(opt.latency_sampling)))
             ("mode","Benchmark mode",cxxopts::value<std::string>()->default_value("operation"))
             ("time","Time PiBench run in time-based mode",cxxopts::value<float>()->default_value(std::to_string(opt.time)))
+            ("calibrate", "Measure machine baselines (INPUT is optional)", cxxopts::value<bool>()->default_value((opt.calibrate ? "true" : "false")))
+            ("calibration_file", "File to save baselines to or load them from", cxxopts::value<std::string>()->default_value(""))
+            ("jitter_probe", "Run OS jitter probes on \"sibling\" SMT threads of workers or on a cpu list", cxxopts::value<std::string>()->default_value(""))
+            ("jitter_threshold_ns", "Minimum gap recorded by jitter probes", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.jitter_threshold_ns)))
+            ("clients", "Number of client threads submitting requests to 'threads' server threads", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.num_clients)))
+            ("batch_size", "Maximum number of requests a server takes at once", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.batch_size)))
+            ("client_depth", "Maximum number of outstanding requests per client", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.client_depth)))
+            ("virtual_clients", "Number of virtual clients per worker thread", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.virtual_clients)))
+            ("think_time", "Mean think time of virtual clients in microseconds", cxxopts::value<float>()->default_value(std::to_string(opt.think_time_us)))
+            ("think_distribution", "Think time distribution [FIXED | UNIFORM | EXPONENTIAL]", cxxopts::value<std::string>()->default_value("EXPONENTIAL"))
+            ("ttl", "Mean time-to-live of inserted records in milliseconds", cxxopts::value<float>()->default_value(std::to_string(opt.ttl_ms)))
+            ("ttl_distribution", "Time-to-live distribution [FIXED | UNIFORM | EXPONENTIAL]", cxxopts::value<std::string>()->default_value("EXPONENTIAL"))
+            ("arrival_schedule", "Run open-loop with requests arriving as scheduled (e.g. \"const:1e5:10;burst:1e5:1e6:50:450:10\")", cxxopts::value<std::string>()->default_value(""))
+            ("long_scan_threads", "Number of threads running long scans next to the workload", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.long_scan_threads)))
+            ("long_scan_size", "Number of records read by each long scan", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.long_scan_size)))
+            ("long_scan_chunk", "Number of records requested at once by long scans", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.long_scan_chunk)))
+            ("processes", "Number of processes attaching to the tree in pool_path", cxxopts::value<uint32_t>()->default_value(std::to_string(opt.num_processes)))
+            ("cpus", "Cpus to pin worker threads to", cxxopts::value<std::string>()->default_value(""))
+            ("colocate", "Library of a second tree run concurrently", cxxopts::value<std::string>()->default_value(""))
+            ("colocate_cpus", "Cpus to pin worker threads of the second tree to", cxxopts::value<std::string>()->default_value(""))
+            ("colocate_pool_path", "Path to persistent pool of the second tree", cxxopts::value<std::string>()->default_value(""))
+            ("secondary_index", "Library of a secondary index updated in lockstep with the tree", cxxopts::value<std::string>()->default_value(""))
+            ("secondary_pool_path", "Path to persistent pool of the secondary index", cxxopts::value<std::string>()->default_value(""))
+            ("interference", "Repeat run next to interference threads [stream_read | stream_write | random | chase]", cxxopts::value<std::string>()->default_value(""))
+            ("interference_threads", "Number of interference threads of each run", cxxopts::value<std::string>()->default_value("0,1,2,4"))
+            ("interference_cpus", "Cpus to pin interference threads to", cxxopts::value<std::string>()->default_value(""))
+            ("interference_footprint", "Buffer size of each interference thread (in Bytes)", cxxopts::value<uint64_t>()->default_value(std::to_string(opt.interference_footprint)))
             ("help", "Print help")
         ;
 
@@ -78,11 +141,21 @@ int main(int argc, char** argv)
             opt.latency_sampling = result["latency_sampling"].as<float>();
         }
 
+        if (result.count("calibrate"))
+        {
+            opt.calibrate = result["calibrate"].as<bool>();
+        }
+
+        if (result.count("calibration_file"))
+        {
+            opt.calibration_file = result["calibration_file"].as<std::string>();
+        }
+
         if (result.count("input"))
         {
             opt.library_file = result["input"].as<std::string>();
         }
-        else
+        else if (!opt.calibrate)
         {
             std::cout << "Missing 'input' argument." << std::endl;
             std::cout << options.help() << std::endl;
@@ -101,6 +174,34 @@ int main(int argc, char** argv)
         if (result.count("threads"))
             opt.num_threads = result["threads"].as<uint32_t>();
 
+        // Parse "growth_start"
+        if (result.count("growth_start"))
+            opt.growth_start = result["growth_start"].as<uint64_t>();
+
+        // Parse "probe_ops"
+        if (result.count("probe_ops"))
+            opt.probe_ops = result["probe_ops"].as<uint64_t>();
+
+        // Parse "memory_budget"
+        if (result.count("memory_budget"))
+            opt.memory_budget = result["memory_budget"].as<uint64_t>();
+
+        // Parse "memory_budget_source"
+        if (result.count("memory_budget_source"))
+            opt.memory_budget_source = result["memory_budget_source"].as<std::string>();
+
+        // Parse "aging_ops"
+        if (result.count("aging_ops"))
+            opt.aging_ops = result["aging_ops"].as<uint64_t>();
+
+        // Parse "aging_batch"
+        if (result.count("aging_batch"))
+            opt.aging_batch = result["aging_batch"].as<uint32_t>();
+
+        // Parse "aging_update_ratio"
+        if (result.count("aging_update_ratio"))
+            opt.aging_update_ratio = result["aging_update_ratio"].as<float>();
+
         // Parse "sampling_ms"
         if (result.count("sampling_ms"))
             opt.sampling_ms = result["sampling_ms"].as<uint32_t>();
@@ -137,6 +238,115 @@ int main(int argc, char** argv)
         if (result.count("scan_size"))
             opt.scan_size = result["scan_size"].as<uint32_t>();
 
+        if (result.count("aggregate_ratio"))
+            opt.aggregate_ratio = result["aggregate_ratio"].as<float>();
+
+        // Parse "aggregate_size"
+        if (result.count("aggregate_size"))
+            opt.aggregate_size = result["aggregate_size"].as<uint64_t>();
+
+        // Parse "aggregate_fallback"
+        if (result.count("aggregate_fallback"))
+            opt.aggregate_fallback = result["aggregate_fallback"].as<bool>();
+
+        if (result.count("remove_range_ratio"))
+            opt.remove_range_ratio = result["remove_range_ratio"].as<float>();
+
+        // Parse "remove_range_size"
+        if (result.count("remove_range_size"))
+            opt.remove_range_size = result["remove_range_size"].as<uint64_t>();
+
+        // Parse "remove_range_fallback"
+        if (result.count("remove_range_fallback"))
+            opt.remove_range_fallback = result["remove_range_fallback"].as<bool>();
+
+        if (result.count("seek_ratio"))
+            opt.seek_ratio = result["seek_ratio"].as<float>();
+
+        // Parse "seek_type"
+        if (result.count("seek_type"))
+        {
+            std::string seek = result["seek_type"].as<std::string>();
+            std::transform(seek.begin(), seek.end(), seek.begin(), ::tolower);
+            if(seek.compare("lower_bound") == 0)
+                opt.seek_type = seek_t::LOWER_BOUND;
+            else if(seek.compare("upper_bound") == 0)
+                opt.seek_type = seek_t::UPPER_BOUND;
+            else if(seek.compare("predecessor") == 0)
+                opt.seek_type = seek_t::PREDECESSOR;
+            else
+            {
+                std::cout << "Invalid seek type, must be one of "
+                << "[LOWER_BOUND | UPPER_BOUND | PREDECESSOR], but is " << seek << std::endl;
+                exit(1);
+            }
+        }
+
+        // Parse "seek_gap_ratio"
+        if (result.count("seek_gap_ratio"))
+            opt.seek_gap_ratio = result["seek_gap_ratio"].as<float>();
+
+        // Parse "seek_fallback"
+        if (result.count("seek_fallback"))
+            opt.seek_fallback = result["seek_fallback"].as<bool>();
+
+        // Parse "typed_keys"
+        if (result.count("typed_keys"))
+            opt.typed_keys = result["typed_keys"].as<bool>();
+
+        // Parse "locality_run"
+        if (result.count("locality_run"))
+            opt.locality_run = result["locality_run"].as<uint32_t>();
+
+        // Parse "hints"
+        if (result.count("hints"))
+            opt.hints = result["hints"].as<bool>();
+
+        // Parse "transactions"
+        if (result.count("transactions"))
+            opt.transactions = result["transactions"].as<bool>();
+
+        // Parse "txn_min_keys"
+        if (result.count("txn_min_keys"))
+            opt.txn_min_keys = result["txn_min_keys"].as<uint32_t>();
+
+        // Parse "txn_max_keys"
+        if (result.count("txn_max_keys"))
+            opt.txn_max_keys = result["txn_max_keys"].as<uint32_t>();
+
+        // Parse "txn_write_ratio"
+        if (result.count("txn_write_ratio"))
+            opt.txn_write_ratio = result["txn_write_ratio"].as<float>();
+
+        // Parse "txn_hot_keys"
+        if (result.count("txn_hot_keys"))
+            opt.txn_hot_keys = result["txn_hot_keys"].as<uint64_t>();
+
+        // Parse "txn_hot_ratio"
+        if (result.count("txn_hot_ratio"))
+            opt.txn_hot_ratio = result["txn_hot_ratio"].as<float>();
+
+        // Parse "duplicates"
+        if (result.count("duplicates"))
+            opt.duplicates = result["duplicates"].as<uint32_t>();
+
+        // Parse "duplicate_skew"
+        if (result.count("duplicate_skew"))
+            opt.duplicate_skew = result["duplicate_skew"].as<float>();
+
+        // Parse "remove_duplicates"
+        if (result.count("remove_duplicates"))
+        {
+            std::string remove = result["remove_duplicates"].as<std::string>();
+            if(remove == "one" || remove == "all")
+                opt.remove_all_duplicates = remove == "all";
+            else
+            {
+                std::cout << "Invalid remove of duplicates, must be one of [one | all], but is " << remove << std::endl;
+                exit(1);
+            }
+        }
+
         // Parse 'key_distribution'
         if(result.count("distribution"))
         {
@@ -165,6 +375,22 @@ int main(int argc, char** argv)
         if (result.count("skew"))
             opt.key_skew = result["skew"].as<float>();
 
+        // Parse "read_distribution"
+        if (result.count("read_distribution"))
+            opt.read_distribution = result["read_distribution"].as<std::string>();
+
+        // Parse "update_distribution"
+        if (result.count("update_distribution"))
+            opt.update_distribution = result["update_distribution"].as<std::string>();
+
+        // Parse "remove_distribution"
+        if (result.count("remove_distribution"))
+            opt.remove_distribution = result["remove_distribution"].as<std::string>();
+
+        // Parse "scan_distribution"
+        if (result.count("scan_distribution"))
+            opt.scan_distribution = result["scan_distribution"].as<std::string>();
+
         // Parse 'rnd_seed'
         if (result.count("seed"))
         {
@@ -203,6 +429,144 @@ int main(int argc, char** argv)
         if(result.count("negative_access_rate"))
             opt.negative_access_rate = result["negative_access_rate"].as<float>();
 
+        // Parse "jitter_probe"
+        if (result.count("jitter_probe"))
+            opt.jitter_probe = result["jitter_probe"].as<std::string>();
+
+        // Parse "jitter_threshold_ns"
+        if (result.count("jitter_threshold_ns"))
+            opt.jitter_threshold_ns = result["jitter_threshold_ns"].as<uint32_t>();
+
+        // Parse "clients"
+        if (result.count("clients"))
+            opt.num_clients = result["clients"].as<uint32_t>();
+
+        // Parse "batch_size"
+        if (result.count("batch_size"))
+            opt.batch_size = result["batch_size"].as<uint32_t>();
+
+        // Parse "client_depth"
+        if (result.count("client_depth"))
+            opt.client_depth = result["client_depth"].as<uint32_t>();
+
+        // Parse "virtual_clients"
+        if (result.count("virtual_clients"))
+            opt.virtual_clients = result["virtual_clients"].as<uint32_t>();
+
+        // Parse "think_time"
+        if (result.count("think_time"))
+            opt.think_time_us = result["think_time"].as<float>();
+
+        // Parse "think_distribution"
+        if (result.count("think_distribution"))
+        {
+            std::string dist = result["think_distribution"].as<std::string>();
+            std::transform(dist.begin(), dist.end(), dist.begin(), ::tolower);
+            if(dist.compare("fixed") == 0)
+                opt.think_distribution = delay_distribution_t::FIXED;
+            else if(dist.compare("uniform") == 0)
+                opt.think_distribution = delay_distribution_t::UNIFORM;
+            else if(dist.compare("exponential") == 0)
+                opt.think_distribution = delay_distribution_t::EXPONENTIAL;
+            else
+            {
+                std::cout << "Invalid think time distribution, must be one of "
+                << "[FIXED | UNIFORM | EXPONENTIAL], but is " << dist << std::endl;
+                exit(1);
+            }
+        }
+
+        // Parse "ttl"
+        if (result.count("ttl"))
+            opt.ttl_ms = result["ttl"].as<float>();
+
+        // Parse "ttl_distribution"
+        if (result.count("ttl_distribution"))
+        {
+            std::string dist = result["ttl_distribution"].as<std::string>();
+            std::transform(dist.begin(), dist.end(), dist.begin(), ::tolower);
+            if(dist.compare("fixed") == 0)
+                opt.ttl_distribution = delay_distribution_t::FIXED;
+            else if(dist.compare("uniform") == 0)
+                opt.ttl_distribution = delay_distribution_t::UNIFORM;
+            else if(dist.compare("exponential") == 0)
+                opt.ttl_distribution = delay_distribution_t::EXPONENTIAL;
+            else
+            {
+                std::cout << "Invalid time-to-live distribution, must be one of "
+                << "[FIXED | UNIFORM | EXPONENTIAL], but is " << dist << std::endl;
+                exit(1);
+            }
+        }
+
+        // Parse "long_scan_threads"
+        if (result.count("long_scan_threads"))
+            opt.long_scan_threads = result["long_scan_threads"].as<uint32_t>();
+
+        // Parse "long_scan_size"
+        if (result.count("long_scan_size"))
+            opt.long_scan_size = result["long_scan_size"].as<uint64_t>();
+
+        // Parse "long_scan_chunk"
+        if (result.count("long_scan_chunk"))
+            opt.long_scan_chunk = result["long_scan_chunk"].as<uint32_t>();
+
+        // Parse "arrival_schedule"
+        if (result.count("arrival_schedule"))
+            opt.arrival_schedule = result["arrival_schedule"].as<std::string>();
+
+        // Parse "processes"
+        if (result.count("processes"))
+            opt.num_processes = result["processes"].as<uint32_t>();
+
+        // Parse "cpus"
+        if (result.count("cpus"))
+            opt.cpus = result["cpus"].as<std::string>();
+
+        // Parse "colocate"
+        if (result.count("colocate"))
+            opt.colocate_library_file = result["colocate"].as<std::string>();
+
+        // Parse "colocate_cpus"
+        if (result.count("colocate_cpus"))
+            opt.colocate_cpus = result["colocate_cpus"].as<std::string>();
+
+        // Parse "colocate_pool_path"
+        if (result.count("colocate_pool_path"))
+            opt.colocate_pool_path = result["colocate_pool_path"].as<std::string>();
+
+        // Parse "secondary_index"
+        if (result.count("secondary_index"))
+            opt.secondary_index = result["secondary_index"].as<std::string>();
+
+        // Parse "secondary_pool_path"
+        if (result.count("secondary_pool_path"))
+            opt.secondary_pool_path = result["secondary_pool_path"].as<std::string>();
+
+        // Parse "interference"
+        if (result.count("interference"))
+        {
+            opt.interference = true;
+            std::string kind = result["interference"].as<std::string>();
+            if (!parse_interference_kind(kind, opt.interference_kind))
+            {
+                std::cout << "Interference must be one of [stream_read | stream_write | random | chase], but is " << kind << std::endl;
+                exit(1);
+            }
+        }
+
+        // Parse "interference_threads"
+        if (result.count("interference_threads"))
+            opt.interference_threads = topology::parse_cpu_list(result["interference_threads"].as<std::string>());
+
+        // Parse "interference_cpus"
+        if (result.count("interference_cpus"))
+            opt.interference_cpus = result["interference_cpus"].as<std::string>();
+
+        // Parse "interference_footprint"
+        if (result.count("interference_footprint"))
+            opt.interference_footprint = result["interference_footprint"].as<uint64_t>();
+
         //Parse "negative_access"
         if(result.count("negative_access"))
         {
@@ -258,7 +622,7 @@ int main(int argc, char** argv)
         exit(1);
     }
 
-    auto sum = opt.read_ratio+opt.insert_ratio+opt.update_ratio+opt.remove_ratio+opt.scan_ratio;
+    auto sum = opt.read_ratio+opt.insert_ratio+opt.update_ratio+opt.remove_ratio+opt.scan_ratio+opt.aggregate_ratio+opt.remove_range_ratio+opt.seek_ratio;
     if (sum != 1.0)
     {
         std::cout << "Sum of ratios should be 1.0 but is " << sum << std::endl;
@@ -272,6 +636,24 @@ int main(int argc, char** argv)
         exit(1);
     }
 
+    if(opt.aggregate_size < 1)
+    {
+        std::cout << "Aggregate size must be at least 1, but is " << opt.aggregate_size << std::endl;
+        exit(1);
+    }
+
+    if(opt.remove_range_size < 1)
+    {
+        std::cout << "Remove range size must be at least 1, but is " << opt.remove_range_size << std::endl;
+        exit(1);
+    }
+
+    if(opt.seek_gap_ratio < 0.0 || opt.seek_gap_ratio > 1.0)
+    {
+        std::cout << "Seek gap ratio must be in the range [0.0 , 1.0]." << std::endl;
+        exit(1);
+    }
+
     if(opt.key_distribution == distribution_t::SELFSIMILAR && (opt.key_skew < 0.0 || opt.key_skew > 0.5))
     {
         std::cout << "Skew factor must be in the range [0 , 0.5]." << std::endl;
@@ -284,20 +666,301 @@ int main(int argc, char** argv)
         exit(1);
     }
 
+    for(auto& [name, spec] : {std::make_pair("read", &opt.read_distribution), std::make_pair("update", &opt.update_distribution),
+                              std::make_pair("delete", &opt.remove_distribution), std::make_pair("scan", &opt.scan_distribution)})
+    {
+        std::vector<key_component_t> mixture;
+        std::string error;
+        if(!spec->empty() && !parse_key_mixture(*spec, opt.key_skew, mixture, error))
+        {
+            std::cout << "Invalid " << name << " key distribution: " << error << std::endl;
+            exit(1);
+        }
+    }
+
     if((opt.latency_sampling < 0.0 || opt.latency_sampling > 1.0))
     {
         std::cout << "Latency sampling must be in the range [0.0 , 1.0]." << std::endl;
         exit(1);
     }
 
-    // Print env and options
-    print_environment();
-    std::cout << opt << std::endl;
+    if(!opt.jitter_probe.empty() && opt.jitter_probe != "sibling" && topology::parse_cpu_list(opt.jitter_probe).empty())
+    {
+        std::cout << "Jitter probe must be \"sibling\" or a cpu list (e.g. 3,7-9), but is " << opt.jitter_probe << std::endl;
+        exit(1);
+    }
+
+    if(opt.duplicates > 0)
+    {
+        if(opt.duplicates > (1u << 20) || opt.duplicate_skew < 0.0)
+        {
+            std::cout << "Duplicates must be at most " << (1u << 20) << " records per key with a skew of at least 0." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.skip_load || opt.num_clients > 0 || opt.growth_start > 0 || opt.memory_budget > 0 || opt.aging_ops > 0 || opt.ttl_ms > 0)
+        {
+            std::cout << "Duplicates are only supported in operation mode without skip_load, clients, growth curves, capacity tests, aging or time-to-live." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.locality_run > 0 || opt.hints)
+    {
+        if(opt.locality_run > benchmark_t::MAX_SCAN)
+        {
+            std::cout << "Locality run must be in the range [0," << benchmark_t::MAX_SCAN << "], but is " << opt.locality_run << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.duplicates > 0 || opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty()
+           || opt.long_scan_threads > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference || opt.ttl_ms > 0 || opt.transactions)
+        {
+            std::cout << "Locality runs and hints are only supported in operation mode without duplicates, clients, virtual clients, arrival schedules,"
+                << " long scans, processes, co-located trees, interference, time-to-live or transactions." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.transactions)
+    {
+        if(opt.txn_min_keys < 1 || opt.txn_max_keys < opt.txn_min_keys || opt.txn_max_keys > opt.num_records
+           || opt.txn_hot_keys > opt.num_records || opt.txn_write_ratio < 0.0 || opt.txn_write_ratio > 1.0
+           || opt.txn_hot_ratio < 0.0 || opt.txn_hot_ratio > 1.0)
+        {
+            std::cout << "Transactions must access between 1 and " << opt.num_records << " keys, with at most as many hot keys"
+                << " and write and hot ratios in the range [0.0 , 1.0]." << std::endl;
+            exit(1);
+        }
+
+        // Keys of a transaction are distinct, all of them may be drawn from the hot records.
+        if(opt.txn_hot_keys > 0 && opt.txn_hot_ratio == 1.0 && opt.txn_hot_keys < opt.txn_max_keys)
+        {
+            std::cout << "Transactions drawing all keys from the hot records need at least " << opt.txn_max_keys
+                << " hot keys, but have " << opt.txn_hot_keys << "." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.duplicates > 0 || opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty()
+           || opt.long_scan_threads > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference || opt.ttl_ms > 0)
+        {
+            std::cout << "Transactions are only supported in operation mode without duplicates, clients, virtual clients, arrival schedules,"
+                << " long scans, processes, co-located trees, interference or time-to-live." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(!opt.secondary_index.empty())
+    {
+        if(opt.aggregate_ratio > 0 || opt.remove_range_ratio > 0 || opt.seek_ratio > 0)
+        {
+            std::cout << "Secondary indexes only support reads, inserts, updates, deletes and scans." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.duplicates > 0 || opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty()
+           || opt.long_scan_threads > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference || opt.ttl_ms > 0
+           || opt.transactions || opt.hints || opt.locality_run > 0 || opt.growth_start > 0 || opt.memory_budget > 0)
+        {
+            std::cout << "Secondary indexes are only supported in operation mode without duplicates, clients, virtual clients, arrival schedules,"
+                << " long scans, processes, co-located trees, interference, time-to-live, transactions, locality runs, hints, growth curves"
+                << " or capacity tests." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.growth_start > 0)
+    {
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.skip_load || opt.num_records == 0)
+        {
+            std::cout << "Growth curves are only supported in operation mode with records loaded." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.memory_budget > 0)
+    {
+        if(opt.memory_budget_source != "rss" && opt.memory_budget_source != "tree")
+        {
+            std::cout << "Memory budget source must be \"rss\" or \"tree\", but is " << opt.memory_budget_source << std::endl;
+            exit(1);
+        }
+
+        // Capacity tests replace the load and run phases.
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.skip_load || opt.growth_start > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty()
+           || opt.interference || opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty() || opt.long_scan_threads > 0
+           || opt.transactions || opt.hints || !opt.secondary_index.empty())
+        {
+            std::cout << "Capacity tests are only supported in operation mode without skip_load, growth curves, processes, co-located trees,"
+                << " interference, clients, virtual clients, arrival schedules, long scans, transactions, hints or secondary indexes." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.aging_ops > 0)
+    {
+        if(opt.aging_batch == 0 || opt.aging_update_ratio < 0.0 || opt.aging_update_ratio > 1.0)
+        {
+            std::cout << "Aging batch must be at least 1 and aging update ratio in the range [0.0 , 1.0]." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.num_records == 0)
+        {
+            std::cout << "Aging is only supported in operation mode with records loaded." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.interference && opt.interference_threads.empty())
+    {
+        std::cout << "Interference threads must be a list of thread counts (e.g. 0,1,2,4)." << std::endl;
+        exit(1);
+    }
+
+    if(opt.num_clients > 0)
+    {
+        if(opt.batch_size == 0 || opt.client_depth == 0)
+        {
+            std::cout << "Batch size and client depth must be at least 1." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference)
+        {
+            std::cout << "Clients are only supported in operation mode without processes, co-located trees or interference." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.virtual_clients > 0)
+    {
+        if(opt.think_time_us < 0.0)
+        {
+            std::cout << "Think time must not be negative." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.num_clients > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference)
+        {
+            std::cout << "Virtual clients are only supported in operation mode without clients, processes, co-located trees or interference." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.ttl_ms < 0.0)
+    {
+        std::cout << "Time-to-live must not be negative." << std::endl;
+        exit(1);
+    }
+
+    if(opt.ttl_ms > 0.0)
+    {
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty() || opt.num_processes > 1)
+        {
+            std::cout << "Time-to-live is only supported in operation mode without clients, virtual clients, arrival schedules or processes." << std::endl;
+            exit(1);
+        }
+    }
+
+    arrival_schedule_t schedule;
+    if(!opt.arrival_schedule.empty())
+    {
+        std::string error;
+        if(!arrival_schedule_t::parse(opt.arrival_schedule, opt.rnd_seed, schedule, error))
+        {
+            std::cout << "Invalid arrival schedule: " << error << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || opt.num_clients > 0 || opt.virtual_clients > 0 || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference)
+        {
+            std::cout << "Arrival schedules are only supported in operation mode without clients, virtual clients, processes, co-located trees or interference." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.long_scan_threads > 0)
+    {
+        if(opt.long_scan_size == 0 || opt.long_scan_chunk < 2 || opt.long_scan_chunk > benchmark_t::MAX_SCAN)
+        {
+            std::cout << "Long scans must read at least 1 record in chunks of 2 to " << benchmark_t::MAX_SCAN << " records." << std::endl;
+            exit(1);
+        }
+
+        if(opt.num_clients > 0 || opt.virtual_clients > 0 || !opt.arrival_schedule.empty() || opt.num_processes > 1 || !opt.colocate_library_file.empty() || opt.interference)
+        {
+            std::cout << "Long scans cannot be combined with clients, virtual clients, arrival schedules, processes, co-located trees or interference." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(opt.num_processes == 0)
+    {
+        std::cout << "Number of processes must be at least 1." << std::endl;
+        exit(1);
+    }
+
+    if(opt.num_processes > 1)
+    {
+        if(tree_opt.pool_path.empty())
+        {
+            std::cout << "Multiple processes require a tree stored in 'pool_path'." << std::endl;
+            exit(1);
+        }
+
+        if(opt.bm_mode != PiBench::mode_t::Operation || !opt.colocate_library_file.empty() || opt.interference)
+        {
+            std::cout << "Multiple processes are only supported in operation mode without co-located trees or interference." << std::endl;
+            exit(1);
+        }
+    }
+
+    if(!opt.colocate_library_file.empty() && opt.interference)
+    {
+        std::cout << "Co-located runs cannot be combined with interference threads." << std::endl;
+        exit(1);
+    }
 
     tree_opt.key_size = opt.key_prefix.size() + opt.key_size + (opt.bm_mode == PiBench::mode_t::Time ? 1:0);
     tree_opt.value_size = opt.value_size;
     tree_opt.num_threads = opt.num_threads;
 
+    // Worker processes are forked before calibration and load run OpenMP regions.
+    std::unique_ptr<multi_process_t> processes;
+    if(opt.num_processes > 1 && !opt.library_file.empty())
+        processes = std::make_unique<multi_process_t>(tree_opt, opt);
+
+    // Print env and options
+    print_environment();
+    std::cout << opt << std::endl;
+
+    calibration_t calibration;
+    bool has_calibration = false;
+    if(opt.calibrate)
+    {
+        calibration = calibrate(opt.num_threads, tree_opt.pool_path);
+        has_calibration = true;
+        if(!opt.calibration_file.empty() && !calibration.save(opt.calibration_file))
+            std::cout << "Could not save calibration to " << opt.calibration_file << std::endl;
+    }
+    else if(!opt.calibration_file.empty())
+    {
+        std::string error;
+        if(!calibration.load(opt.calibration_file, error))
+        {
+            std::cout << "Could not load calibration from " << opt.calibration_file << ": " << error << std::endl;
+            exit(1);
+        }
+        has_calibration = true;
+    }
+
+    if(has_calibration)
+        std::cout << calibration << std::endl;
+
+    if(opt.library_file.empty())
+        return 0;
+
     library_loader_t lib(opt.library_file);
     tree_api* tree = lib.create_tree(tree_opt);
     if(tree == nullptr)
@@ -306,9 +969,116 @@ int main(int argc, char** argv)
         exit(1);
     }
 
+    if(opt.duplicates > 0 && !(tree->capabilities() & TREE_CAP_MULTIMAP))
+    {
+        std::cout << "Tree does not support duplicate keys." << std::endl;
+        exit(1);
+    }
+
+    if(opt.seek_ratio > 0 && opt.seek_type == seek_t::PREDECESSOR && (opt.seek_fallback || !(tree->capabilities() & TREE_CAP_SEEK)))
+    {
+        std::cout << "Predecessor seeks cannot fall back to scans, the tree must support seeks." << std::endl;
+        exit(1);
+    }
+
+    if(opt.hints && !(tree->capabilities() & TREE_CAP_HINT))
+    {
+        std::cout << "Tree does not support hints." << std::endl;
+        exit(1);
+    }
+
+    if(opt.transactions && !(tree->capabilities() & TREE_CAP_TRANSACTIONS))
+    {
+        std::cout << "Tree does not support transactions." << std::endl;
+        exit(1);
+    }
+
     benchmark_t bench(tree, opt);
-    bench.load();
-    bench.run();
+    if(has_calibration)
+        bench.set_calibration(calibration);
+    if(opt.memory_budget > 0)
+    {
+        // Capacity tests replace the load and run phases.
+        bench.run_capacity();
+        delete tree;
+        return 0;
+    }
+
+    if(opt.growth_start > 0)
+        bench.load_growth();
+    else
+        bench.load();
+
+    if(processes)
+    {
+        // Close the loaded tree, worker processes attach to it through the pool.
+        delete tree;
+        processes->run();
+        return 0;
+    }
+
+    if(!opt.colocate_library_file.empty())
+    {
+        // Second tenant runs the same workload, PCM and probes only observe the first.
+        options_t colocate_opt = opt;
+        colocate_opt.library_file = opt.colocate_library_file;
+        colocate_opt.cpus = opt.colocate_cpus;
+        colocate_opt.enable_pcm = false;
+        colocate_opt.jitter_probe = "";
+
+        tree_options_t colocate_tree_opt = tree_opt;
+        colocate_tree_opt.pool_path = opt.colocate_pool_path;
+
+        library_loader_t colocate_lib(colocate_opt.library_file);
+        tree_api* colocate_tree = colocate_lib.create_tree(colocate_tree_opt);
+        if(colocate_tree == nullptr)
+        {
+            std::cout << "Error instantiating co-located tree." << std::endl;
+            exit(1);
+        }
+
+        benchmark_t colocate_bench(colocate_tree, colocate_opt);
+        if(has_calibration)
+            colocate_bench.set_calibration(calibration);
+        colocate_bench.load();
+
+        run_colocated(bench, colocate_bench, opt.library_file, colocate_opt.library_file);
+        delete colocate_tree;
+    }
+    else if(opt.interference)
+        bench.run_interference();
+    else if(opt.num_clients > 0)
+        bench.run_client_server();
+    else if(opt.virtual_clients > 0)
+        bench.run_virtual_clients();
+    else if(!opt.arrival_schedule.empty())
+        bench.run_schedule(schedule);
+    else if(opt.long_scan_threads > 0)
+        bench.run_long_scans();
+    else if(!opt.secondary_index.empty())
+    {
+        // Secondary index maps attributes to primary keys, which are its values.
+        tree_options_t secondary_tree_opt = tree_opt;
+        secondary_tree_opt.value_size = tree_opt.key_size;
+        secondary_tree_opt.pool_path = opt.secondary_pool_path;
+
+        library_loader_t secondary_lib(opt.secondary_index);
+        tree_api* secondary = secondary_lib.create_tree(secondary_tree_opt);
+        if(secondary == nullptr)
+        {
+            std::cout << "Error instantiating secondary index." << std::endl;
+            exit(1);
+        }
+
+        bench.run_secondary_index(secondary);
+        delete secondary;
+    }
+    else if(opt.transactions)
+        bench.run_transactions();
+    else if(opt.hints)
+        bench.run_hints();
+    else
+        bench.run();
 
     delete tree;
     return 0;
@@ -0,0 +1,293 @@
+#include "multi_process.hpp"
+#include "cpu_topology.hpp"
+#include "library_loader.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace PiBench
+{
+
+namespace
+{
+/// Barriers shared by worker processes.
+struct shared_state_t
+{
+    /// Released once all processes attached to the tree.
+    pthread_barrier_t start;
+
+    /// Released once all processes finished their operations.
+    pthread_barrier_t end;
+};
+
+/// Results of one process, its latency samples are stored separately.
+struct process_result_t
+{
+    bool attached;
+    uint64_t operations;
+    uint64_t failed;
+    float elapsed_ms;
+    double throughput;
+    uint64_t num_latencies;
+};
+
+/// Cpu list of the workers of a process, a slice of the cpus given in options.
+std::string process_cpus(const options_t& opt, uint32_t process)
+{
+    auto cpus = topology::parse_cpu_list(opt.cpus);
+    if (cpus.empty())
+        return "";
+
+    std::string list;
+    for (uint32_t t = 0; t < opt.num_threads; ++t)
+    {
+        if (!list.empty())
+            list += ",";
+        list += std::to_string(cpus[(process * opt.num_threads + t) % cpus.size()]);
+    }
+    return list;
+}
+} // namespace
+
+multi_process_t::multi_process_t(const tree_options_t& tree_opt, const options_t& opt)
+    : tree_opt_(tree_opt)
+    , opt_(opt)
+    , release_fd_(-1)
+{
+    const uint32_t processes = opt_.num_processes;
+
+    ops_per_process_ = opt_.num_ops / processes;
+    ops_last_ = ops_per_process_ + opt_.num_ops % processes;
+
+    // Ids reserved for inserts of each process, computed as benchmark_t::run() does.
+    const uint64_t inserts_per_thread = 10 + (ops_last_ * opt_.insert_ratio) / opt_.num_threads;
+    inserts_per_process_ = inserts_per_thread * opt_.num_threads;
+
+    max_latencies_ = static_cast<uint64_t>(ops_last_ * opt_.latency_sampling * 1.2) + 4096;
+
+    size_t results_offset = sizeof(shared_state_t);
+    latencies_offset_ = results_offset + processes * sizeof(process_result_t);
+    latencies_offset_ = (latencies_offset_ + 63) & ~static_cast<size_t>(63);
+    size_ = latencies_offset_ + processes * max_latencies_ * sizeof(uint64_t);
+
+    mem_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem_ == MAP_FAILED)
+    {
+        std::cout << "Error mapping shared segment." << std::endl;
+        exit(1);
+    }
+
+    auto shared = new (mem_) shared_state_t;
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&shared->start, &attr, processes);
+    pthread_barrier_init(&shared->end, &attr, processes);
+    pthread_barrierattr_destroy(&attr);
+
+    // Processes block reading the pipe, and exit if it is closed before they read a byte.
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        std::cout << "Error creating pipe." << std::endl;
+        exit(1);
+    }
+
+    // Output buffered so far must not be flushed again by the processes.
+    std::cout.flush();
+
+    for (uint32_t p = 0; p < processes; ++p)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            std::cout << "Error forking process " << p << "." << std::endl;
+            exit(1);
+        }
+
+        if (pid == 0)
+        {
+            close(fds[1]);
+            work(p, fds[0]);
+        }
+        pids_.push_back(pid);
+    }
+
+    close(fds[0]);
+    release_fd_ = fds[1];
+}
+
+multi_process_t::~multi_process_t()
+{
+    if (release_fd_ >= 0)
+    {
+        close(release_fd_);
+        wait_all();
+    }
+
+    auto shared = static_cast<shared_state_t*>(mem_);
+    pthread_barrier_destroy(&shared->start);
+    pthread_barrier_destroy(&shared->end);
+    munmap(mem_, size_);
+}
+
+void multi_process_t::work(uint32_t p, int release_fd)
+{
+    char go;
+    if (read(release_fd, &go, 1) != 1)
+        _exit(0);
+    close(release_fd);
+
+    auto shared = static_cast<shared_state_t*>(mem_);
+    auto results = reinterpret_cast<process_result_t*>(static_cast<char*>(mem_) + sizeof(shared_state_t));
+    auto latencies = reinterpret_cast<uint64_t*>(static_cast<char*>(mem_) + latencies_offset_);
+
+    auto& r = results[p];
+    r = process_result_t{};
+
+    library_loader_t lib(opt_.library_file);
+    tree_api* tree = lib.create_tree(tree_opt_);
+    r.attached = tree != nullptr;
+
+    options_t popt = opt_;
+    popt.num_ops = p == opt_.num_processes - 1 ? ops_last_ : ops_per_process_;
+    popt.num_processes = 1;
+    popt.skip_load = true;
+    popt.aging_ops = 0;
+    popt.growth_start = 0;
+    popt.calibrate = false;
+    popt.enable_pcm = false;
+    popt.jitter_probe = "";
+    popt.rnd_seed = opt_.rnd_seed + p * 1000003;
+    popt.cpus = process_cpus(opt_, p);
+
+    // Reports of processes are replaced by the aggregated one.
+    std::ostringstream report;
+    std::unique_ptr<benchmark_t> bench;
+    if (tree)
+    {
+        bench = std::make_unique<benchmark_t>(tree, popt);
+        bench->set_output(report);
+        bench->load();
+        bench->skip_insert_ids(p * inserts_per_process_);
+    }
+
+    pthread_barrier_wait(&shared->start);
+    if (bench)
+    {
+        auto res = bench->run();
+        r.operations = res.operations;
+        r.failed = res.failed;
+        r.elapsed_ms = res.elapsed_ms;
+        r.throughput = res.throughput;
+        r.num_latencies = std::min<uint64_t>(res.latencies.size(), max_latencies_);
+        std::copy(res.latencies.begin(), res.latencies.begin() + r.num_latencies,
+                  latencies + p * max_latencies_);
+    }
+    pthread_barrier_wait(&shared->end);
+
+    bench.reset();
+    delete tree;
+    _exit(0);
+}
+
+void multi_process_t::wait_all()
+{
+    while (wait(nullptr) > 0)
+        ;
+}
+
+void multi_process_t::run()
+{
+    const uint32_t processes = opt_.num_processes;
+    auto results = reinterpret_cast<process_result_t*>(static_cast<char*>(mem_) + sizeof(shared_state_t));
+    auto latencies = reinterpret_cast<uint64_t*>(static_cast<char*>(mem_) + latencies_offset_);
+
+    std::vector<char> go(processes, 1);
+    if (write(release_fd_, go.data(), go.size()) != static_cast<ssize_t>(go.size()))
+    {
+        std::cout << "Error releasing processes." << std::endl;
+        exit(1);
+    }
+    close(release_fd_);
+    release_fd_ = -1;
+
+    // Processes wait on each other at the barriers, so a failed process blocks the others forever.
+    for (uint32_t running = processes; running > 0; --running)
+    {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto p = std::find(pids_.begin(), pids_.end(), pid) - pids_.begin();
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cout << "Process " << p << " failed." << std::endl;
+            for (auto other : pids_)
+                if (other != pid)
+                    kill(other, SIGKILL);
+            wait_all();
+            exit(1);
+        }
+    }
+
+    bool failed = false;
+    for (uint32_t p = 0; p < processes; ++p)
+    {
+        if (!results[p].attached)
+        {
+            std::cout << "Process " << p << " could not attach to the tree." << std::endl;
+            failed = true;
+        }
+    }
+    if (failed)
+        exit(1);
+
+    // Processes start together, the run ends with the slowest one. Reports and latencies are not timed.
+    float elapsed = 0;
+    for (uint32_t p = 0; p < processes; ++p)
+        elapsed = std::max(elapsed, results[p].elapsed_ms);
+
+    uint64_t op_num = 0;
+    uint64_t op_num_f = 0;
+    std::vector<uint64_t> global_latencies;
+    for (uint32_t p = 0; p < processes; ++p)
+    {
+        op_num += results[p].operations;
+        op_num_f += results[p].failed;
+        global_latencies.insert(global_latencies.end(), latencies + p * max_latencies_,
+                                latencies + p * max_latencies_ + results[p].num_latencies);
+    }
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Processes (" << processes << " * " << opt_.num_threads << " threads):" << "\n"
+              << "\tRun time: " << elapsed << " milliseconds" << "\n"
+              << "\tThroughput: " << op_num / ((double)elapsed / 1000) << " ops/s" << "\n"
+              << "\tFalse access rate: " << ((float)op_num_f * 100.0 / op_num) << "%" << std::endl;
+    for (uint32_t p = 0; p < processes; ++p)
+        std::cout << "\tProcess " << p << ": " << results[p].throughput << " ops/s ("
+                  << results[p].elapsed_ms << " milliseconds)" << std::endl;
+
+    if (!global_latencies.empty())
+    {
+        std::sort(global_latencies.begin(), global_latencies.end());
+        auto observed = global_latencies.size();
+        std::cout << "Latencies (" << observed << " operations observed):\n"
+                  << "\tmin: " << global_latencies[0] << '\n'
+                  << "\t50%: " << global_latencies[0.5*observed] << '\n'
+                  << "\t90%: " << global_latencies[0.9*observed] << '\n'
+                  << "\t99%: " << global_latencies[0.99*observed] << '\n'
+                  << "\t99.9%: " << global_latencies[0.999*observed] << '\n'
+                  << "\t99.99%: " << global_latencies[0.9999*observed] << '\n'
+                  << "\t99.999%: " << global_latencies[0.99999*observed] << '\n'
+                  << "\tmax: " << global_latencies[observed-1] << std::endl;
+    }
+}
+} // namespace PiBench
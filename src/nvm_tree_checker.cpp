@@ -1,14 +1,332 @@
 #include "tree_api.hpp"
 #include "library_loader.hpp"
+#include "linearizability_checker.hpp"
+#include "tree_oracle.hpp"
+#include "stopwatch.hpp"
+#include "value_generator.hpp"
 #include "cxxopts.hpp"
 
-#include <map>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <omp.h>
+#include <random>
+#include <thread>
+
+using namespace PiBench;
+
+/// Maximum number of records to be scanned.
+static constexpr size_t MAX_SCAN = 1000;
+
+/**
+ * @brief Check a tree against an oracle, using multiple threads.
+ *
+ * The id space of the oracle is split in one contiguous slice per thread and
+ * every thread only issues writes on its own slice, so results of all point
+ * operations are exactly predictable. The check runs in four phases:
+ *     1. Load: every thread inserts all ids of its slice.
+ *     2. Mixed: random finds, inserts, updates and removes on own slice.
+ *     3. Verify: every thread looks up all ids of its slice.
+ *     4. Scan: read-only scans starting at random keys of the whole space.
+ *
+ * @return true if all results matched the oracle and no version wrapped.
+ */
+static bool check_oracle(tree_api* tree, tree_oracle_t& oracle, uint64_t num_ops, uint32_t num_threads,
+                         uint32_t scan_size, uint32_t seed)
+{
+    const uint64_t num_ids = oracle.size();
+    const size_t key_sz = oracle.key_size();
+    const size_t value_sz = oracle.value_size();
+    const uint64_t slice = (num_ids + num_threads - 1) / num_threads;
+    std::atomic<bool> failed(false);
+
+    auto fail = [&failed](const char* what, uint64_t id) {
+        if(!failed.exchange(true))
+            std::cout << "Different results for " << what << " (id " << id << ")." << std::endl;
+    };
+
+    // Check result of a find against the oracle.
+    auto check_find = [&](uint64_t id, char* key, char* value_out, char* expected) {
+        oracle.key(id, key);
+        auto r = tree->find(key, key_sz, value_out);
+        if(r != oracle.present(id))
+            return false;
+        if(r)
+        {
+            oracle.value(id, expected);
+            return memcmp(value_out, expected, value_sz) == 0;
+        }
+        return true;
+    };
+
+    stopwatch_t sw;
+    auto phase = [&sw](const char* name) {
+        std::cout << "\t" << name << ": " << sw.elapsed<std::chrono::milliseconds>() << " milliseconds" << std::endl;
+        sw.start();
+    };
+
+    std::cout << "Phases:" << std::endl;
+    sw.start();
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        auto tid = omp_get_thread_num();
+        const uint64_t lo = 1 + tid * slice;
+        const uint64_t hi = std::min(num_ids, lo + slice - 1);
+
+        char key[key_generator_t::KEY_MAX];
+        char value[value_generator_t::VALUE_MAX];
+        char value_out[value_generator_t::VALUE_MAX];
+        char expected[value_generator_t::VALUE_MAX];
+
+        // Load
+        for(uint64_t id=lo; id<=hi && !failed.load(std::memory_order_relaxed); ++id)
+        {
+            oracle.key(id, key);
+            auto expect = oracle.insert(id);
+            oracle.value(id, value);
+            if(tree->insert(key, key_sz, value, value_sz) != expect)
+                fail("insert", id);
+        }
+
+        #pragma omp barrier
+        #pragma omp master
+        phase("Load");
+        #pragma omp barrier
+
+        // Mixed
+        if(lo <= hi)
+        {
+            std::mt19937_64 rnd(seed * (tid + 1));
+            std::uniform_int_distribution<uint64_t> id_dist(lo, hi);
+            std::discrete_distribution<int> op_dist({40, 20, 20, 20});
+            const uint64_t ops = num_ops / num_threads + (static_cast<uint64_t>(tid) < num_ops % num_threads);
+
+            for(uint64_t i=0; i<ops && !failed.load(std::memory_order_relaxed); ++i)
+            {
+                auto id = id_dist(rnd);
+                oracle.key(id, key);
+                switch(op_dist(rnd))
+                {
+                    case 0:
+                        if(!check_find(id, key, value_out, expected))
+                            fail("find", id);
+                        break;
+
+                    case 1:
+                    {
+                        auto expect = oracle.insert(id);
+                        oracle.value(id, value);
+                        if(tree->insert(key, key_sz, value, value_sz) != expect)
+                            fail("insert", id);
+                        break;
+                    }
+
+                    case 2:
+                    {
+                        auto expect = oracle.update(id);
+                        oracle.value(id, value);
+                        if(tree->update(key, key_sz, value, value_sz) != expect)
+                            fail("update", id);
+                        break;
+                    }
+
+                    case 3:
+                        if(tree->remove(key, key_sz) != oracle.remove(id))
+                            fail("delete", id);
+                        break;
+                }
+            }
+        }
+
+        #pragma omp barrier
+        #pragma omp master
+        phase("Mixed");
+        #pragma omp barrier
+
+        // Verify
+        for(uint64_t id=lo; id<=hi && !failed.load(std::memory_order_relaxed); ++id)
+            if(!check_find(id, key, value_out, expected))
+                fail("find", id);
+
+        #pragma omp barrier
+        #pragma omp master
+        {
+            phase("Verify");
+            if(!failed.load())
+                oracle.sort(num_threads);
+            phase("Sort");
+        }
+        #pragma omp barrier
+
+        // Scan
+        {
+            std::mt19937_64 rnd(seed * (tid + 1) + 1);
+            std::uniform_int_distribution<uint64_t> id_dist(1, num_ids);
+            const uint64_t scans = std::max<uint64_t>(num_ops / 10, 1) / num_threads;
+            std::vector<uint64_t> ids(scan_size);
+
+            for(uint64_t i=0; i<scans && !failed.load(std::memory_order_relaxed); ++i)
+            {
+                auto id = id_dist(rnd);
+                oracle.key(id, key);
+
+                char* values_out;
+                auto scanned = tree->scan(key, key_sz, scan_size, values_out);
+                auto expect = oracle.scan(id, scan_size, ids.data());
+                if(scanned < 0 || static_cast<size_t>(scanned) != expect)
+                {
+                    fail("scan", id);
+                    break;
+                }
+
+                const char* rec = values_out;
+                for(size_t j=0; j<expect; ++j)
+                {
+                    oracle.key(ids[j], key);
+                    oracle.value(ids[j], expected);
+                    if(memcmp(rec, key, key_sz) != 0 || memcmp(rec + key_sz, expected, value_sz) != 0)
+                    {
+                        fail("scan", id);
+                        break;
+                    }
+                    rec += key_sz + value_sz;
+                }
+            }
+        }
+
+        #pragma omp barrier
+        #pragma omp master
+        phase("Scan");
+    }
+
+    if(oracle.wrapped())
+    {
+        std::cout << "Oracle versions wrapped, lost updates may have gone undetected." << std::endl;
+        return false;
+    }
+    return !failed.load();
+}
+
+/**
+ * @brief Run a concurrent workload and check that its history is linearizable.
+ *
+ * Every thread issues random finds, inserts, updates and removes on a small
+ * key space and records the invocation and response timestamp of each
+ * operation in a thread-local buffer. Values written are unique, so every
+ * successful find identifies the write it observed. After all threads finish,
+ * the history is checked in parallel, one key at a time.
+ *
+ * Before the run, even keys are loaded with their own key as value.
+ */
+static bool check_concurrent(tree_api* tree, uint32_t num_threads, uint64_t ops_per_thread, uint64_t num_keys)
+{
+    for(uint64_t k=0; k<num_keys; k+=2)
+    {
+        if(!tree->insert(reinterpret_cast<const char*>(&k), sizeof(uint64_t),
+            reinterpret_cast<const char*>(&k), sizeof(uint64_t)))
+        {
+            std::cout << "Different results for insert." << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<history_recorder_t> recorders;
+    recorders.reserve(num_threads);
+    for(uint32_t t=0; t<num_threads; ++t)
+        recorders.emplace_back(ops_per_thread);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        auto tid = omp_get_thread_num();
+        auto& recorder = recorders[tid];
+        std::mt19937_64 rnd(1729 * (tid + 1));
+        std::uniform_int_distribution<uint64_t> key_dist(0, num_keys - 1);
+        std::discrete_distribution<int> op_dist({50, 15, 20, 15});
+
+        #pragma omp barrier
+        for(uint64_t i=0; i<ops_per_thread; ++i)
+        {
+            history_event_t e;
+            e.key = key_dist(rnd);
+            e.op = static_cast<history_op_t>(op_dist(rnd));
+            // Unique value per write: thread id in the high bits.
+            e.value = (static_cast<uint64_t>(tid + 1) << 40) | i;
+
+            auto k = reinterpret_cast<const char*>(&e.key);
+            auto v = reinterpret_cast<const char*>(&e.value);
+            uint64_t value_out = 0;
+
+            e.invoke = history_recorder_t::invoke();
+            switch(e.op)
+            {
+                case history_op_t::FIND:
+                    e.result = tree->find(k, sizeof(uint64_t), reinterpret_cast<char*>(&value_out));
+                    break;
+                case history_op_t::INSERT:
+                    e.result = tree->insert(k, sizeof(uint64_t), v, sizeof(uint64_t));
+                    break;
+                case history_op_t::UPDATE:
+                    e.result = tree->update(k, sizeof(uint64_t), v, sizeof(uint64_t));
+                    break;
+                case history_op_t::REMOVE:
+                    e.result = tree->remove(k, sizeof(uint64_t));
+                    break;
+            }
+            e.response = history_recorder_t::respond();
+
+            if(e.op == history_op_t::FIND)
+                e.value = value_out;
+            recorder.record(e);
+        }
+    }
+
+    std::vector<const std::vector<history_event_t>*> histories;
+    for(auto& r : recorders)
+        histories.push_back(&r.events());
+
+    linearizability_checker_t checker(
+        [](uint64_t key, uint64_t& value) {
+            value = key;
+            return key % 2 == 0;
+        },
+        num_threads);
+    auto result = checker.check(histories);
+
+    std::cout << "Checked " << result.operations << " operations on "
+              << result.keys << " keys." << std::endl;
+
+    if(!result.inconclusive.empty())
+    {
+        std::cout << "Search budget exceeded for " << result.inconclusive.size()
+                  << " keys (e.g. key " << result.inconclusive.front()
+                  << "), consider a larger key space." << std::endl;
+    }
+
+    if(!result.violations.empty())
+    {
+        std::cout << "Non-linearizable history for " << result.violations.size()
+                  << " keys (e.g. key " << result.violations.front() << ")." << std::endl;
+        return false;
+    }
+    return true;
+}
 
 int main(int argc, char** argv)
 {
     std::string library_file;
     tree_options_t tree_opt;
+    uint64_t num_records = 10000000;
+    uint64_t num_ops = 10000000;
+    uint32_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string key_prefix = "";
+    uint32_t key_size = 8;
+    uint32_t value_size = 8;
+    uint32_t scan_size = 100;
+    uint32_t rnd_seed = 1729;
+    bool linearizability = false;
+    uint64_t history_ops = 100000;
+    uint64_t history_keys = 100000;
     try
     {
         cxxopts::Options options("nvm_tree_checker", "Check utility for persistent trees.");
@@ -18,8 +336,20 @@ int main(int argc, char** argv)
 
         options.add_options()
             ("input", "Absolute path to library file", cxxopts::value<std::string>())
+            ("n,records", "Number of records to load", cxxopts::value<uint64_t>()->default_value(std::to_string(num_records)))
+            ("p,operations", "Number of operations to execute", cxxopts::value<uint64_t>()->default_value(std::to_string(num_ops)))
+            ("t,threads", "Number of threads to use", cxxopts::value<uint32_t>()->default_value(std::to_string(num_threads)))
+            ("f,key_prefix", "Prefix string prepended to every key", cxxopts::value<std::string>()->default_value("\"" + key_prefix + "\""))
+            ("k,key_size", "Size of keys in Bytes (without prefix)", cxxopts::value<uint32_t>()->default_value(std::to_string(key_size)))
+            ("v,value_size", "Size of values in Bytes", cxxopts::value<uint32_t>()->default_value(std::to_string(value_size)))
+            ("scan_size", "Number of records to be scanned.", cxxopts::value<uint32_t>()->default_value(std::to_string(scan_size)))
+            ("seed", "Seed for random generators", cxxopts::value<uint32_t>()->default_value(std::to_string(rnd_seed)))
             ("pool_path", "Path to persistent pool", cxxopts::value<std::string>()->default_value(""))
             ("pool_size", "Size of persistent pool (in Bytes)", cxxopts::value<uint64_t>()->default_value("0"))
+            ("linearizability", "Check linearizability of a concurrent run instead", cxxopts::value<bool>()->default_value("false"))
+            ("history_ops", "Operations per thread in linearizability mode", cxxopts::value<uint64_t>()->default_value(std::to_string(history_ops)))
+            ("history_keys", "Number of distinct keys in linearizability mode", cxxopts::value<uint64_t>()->default_value(std::to_string(history_keys)))
+            ("help", "Print help")
         ;
 
         options.parse_positional({"input"});
@@ -41,6 +371,38 @@ int main(int argc, char** argv)
             exit(0);
         }
 
+        // Parse "num_records"
+        if (result.count("records"))
+            num_records = result["records"].as<uint64_t>();
+
+        // Parse "num_operations"
+        if (result.count("operations"))
+            num_ops = result["operations"].as<uint64_t>();
+
+        // Parse "num_threads"
+        if (result.count("threads"))
+            num_threads = result["threads"].as<uint32_t>();
+
+        // Parse "key_prefix"
+        if (result.count("key_prefix"))
+            key_prefix = result["key_prefix"].as<std::string>();
+
+        // Parse "key_size"
+        if (result.count("key_size"))
+            key_size = result["key_size"].as<uint32_t>();
+
+        // Parse "value_size"
+        if (result.count("value_size"))
+            value_size = result["value_size"].as<uint32_t>();
+
+        // Parse 'scan_size'
+        if (result.count("scan_size"))
+            scan_size = result["scan_size"].as<uint32_t>();
+
+        // Parse 'rnd_seed'
+        if (result.count("seed"))
+            rnd_seed = result["seed"].as<uint32_t>();
+
         // Parse "pool_path"
         if (result.count("pool_path"))
             tree_opt.pool_path = result["pool_path"].as<std::string>();
@@ -53,6 +415,17 @@ int main(int argc, char** argv)
         else
             tree_opt.pool_size = 0;
 
+        // Parse "linearizability"
+        if (result.count("linearizability"))
+            linearizability = result["linearizability"].as<bool>();
+
+        // Parse "history_ops"
+        if (result.count("history_ops"))
+            history_ops = result["history_ops"].as<uint64_t>();
+
+        // Parse "history_keys"
+        if (result.count("history_keys"))
+            history_keys = result["history_keys"].as<uint64_t>();
     }
     catch (const cxxopts::OptionException& e)
     {
@@ -60,171 +433,73 @@ int main(int argc, char** argv)
         exit(1);
     }
 
-    tree_opt.key_size = 8;
-    tree_opt.value_size = 8;
-    tree_opt.num_threads = 1;
-
-    library_loader lib(library_file);
-    tree_api* tree = lib.create_tree(tree_opt);
-    if(tree == nullptr)
+    // Sanitize options
+    if(num_threads == 0 || num_records == 0 || history_keys == 0)
     {
-        std::cout << "Error instantiating tree." << std::endl;
-        exit(0);
+        std::cout << "Number of threads, records and keys must be larger than 0." << std::endl;
+        exit(1);
     }
 
-    // Mirror data structure used to crosscheck results.
-    std::map<uint64_t, uint64_t> mirror;
-
-    // Initialize random
-    std::srand(1729);
-
-    // Insert 10 million records
-    const uint32_t nrecords = 10000000ULL;
-    for(uint32_t i=0; i<nrecords; ++i)
+    if(key_prefix.size() + key_size > key_generator_t::KEY_MAX)
     {
-        uint64_t k = i;
-        uint64_t v = std::rand();
-
-        auto r1 = mirror.insert(std::make_pair(k,v));
-
-        auto r2 = tree->insert(reinterpret_cast<const char*>(&k), sizeof(uint64_t), 
-            reinterpret_cast<const char*>(&v), sizeof(uint64_t));
-
-        if(r1.second != r2)
-        {
-            std::cout << "Different results for insert." << std::endl;
-            exit(1);
-        }
+        std::cout << "Total key size cannot be greater than " << key_generator_t::KEY_MAX
+                  << ", but is " << key_prefix.size() + key_size << std::endl;
+        exit(1);
     }
 
-    // Do 5 million lookups
-    for(uint32_t i=0; i<5000000; ++i)
+    // Truncated keys are only unique while ids fit in the key.
+    if(key_size == 0 || (key_size < sizeof(uint64_t) && num_records >= (1ull << (key_size * 8))))
     {
-        uint64_t k = std::rand() % nrecords;
-
-        auto r1 = mirror.find(k);
-
-        uint64_t value_out;
-        auto r2 = tree->find(reinterpret_cast<const char*>(&k), sizeof(uint64_t),
-            reinterpret_cast<char*>(&value_out));
-
-        if (((r1 != mirror.end()) != r2)
-            ||
-            ((r2) && (r1->second != value_out)))
-        {
-            std::cout << "Different results for find." << std::endl;
-            exit(1);
-        }
+        std::cout << "Key size of " << key_size << " Bytes cannot hold "
+                  << num_records << " distinct keys." << std::endl;
+        exit(1);
     }
 
-    // Do 5 million updates
-    for(uint32_t i=0; i<5000000; ++i)
+    if(value_size == 0 || value_size > value_generator_t::VALUE_MAX)
     {
-        uint64_t k = std::rand() % nrecords;
-        uint64_t v = std::rand();
-
-        auto it = mirror.find(k);
-        if(it != mirror.end())
-            it->second = v;
-
-        auto r = tree->update(reinterpret_cast<const char*>(&k), sizeof(uint64_t), 
-            reinterpret_cast<const char*>(&v), sizeof(uint64_t));
-
-        if ((it != mirror.end()) != r)
-        {
-            std::cout << "Different results for update." << std::endl;
-            exit(1);
-        }
+        std::cout << "Value size must be in the range [1," << value_generator_t::VALUE_MAX
+                  << "], but is " << value_size << std::endl;
+        exit(1);
     }
 
-    // Do 5 million lookups
-    for(uint32_t i=0; i<5000000; ++i)
+    if(scan_size < 1 || scan_size > MAX_SCAN)
     {
-        uint64_t k = std::rand() % nrecords;
-
-        auto r1 = mirror.find(k);
-
-        uint64_t value_out;
-        auto r2 = tree->find(reinterpret_cast<const char*>(&k), sizeof(uint64_t),
-            reinterpret_cast<char*>(&value_out));
-
-        if (((r1 != mirror.end()) != r2)
-            ||
-            ((r2) && (r1->second != value_out)))
-        {
-            std::cout << "Different results for find." << std::endl;
-            exit(1);
-        }
+        std::cout << "Scan size must be in the range [1," << MAX_SCAN
+                  << "], but is " << scan_size << std::endl;
+        exit(1);
     }
 
-    // Do 5 million deletes
-    for(uint32_t i=0; i<5000000; ++i)
-    {
-        uint64_t k = std::rand() % nrecords;
-
-        auto r1 = mirror.erase(k);
-        auto r2 = tree->remove(reinterpret_cast<const char*>(&k), sizeof(uint64_t));
+    // Linearizability mode works on plain 8 Byte integer keys and values.
+    tree_opt.key_size = linearizability ? sizeof(uint64_t) : key_prefix.size() + key_size;
+    tree_opt.value_size = linearizability ? sizeof(uint64_t) : value_size;
+    tree_opt.num_threads = num_threads;
 
-        if ((r1 > 0) != r2)
-        {
-            std::cout << "Different results for delete." << std::endl;
-            exit(1);
-        }
+    library_loader_t lib(library_file);
+    tree_api* tree = lib.create_tree(tree_opt);
+    if(tree == nullptr)
+    {
+        std::cout << "Error instantiating tree." << std::endl;
+        exit(0);
     }
 
-    // Do 5 million lookups
-    for(uint32_t i=0; i<5000000; ++i)
+    bool ok;
+    if(linearizability)
     {
-        uint64_t k = std::rand() % nrecords;
-
-        auto r1 = mirror.find(k);
-
-        uint64_t value_out;
-        auto r2 = tree->find(reinterpret_cast<const char*>(&k), sizeof(uint64_t),
-            reinterpret_cast<char*>(&value_out));
-
-        if (((r1 != mirror.end()) != r2)
-            ||
-            ((r2) && (r1->second != value_out)))
-        {
-            std::cout << "Different results for find." << std::endl;
-            exit(1);
-        }
+        ok = check_concurrent(tree, num_threads, history_ops, history_keys);
     }
-
-    // Do 1 million scans of 100 records
-    for(uint32_t i=0; i<1000000; ++i)
+    else
     {
-        uint64_t k = std::rand() % nrecords;
-
-        auto it = mirror.lower_bound(k);
-        char values_out1[4096];
-        memset(values_out1, 0, 4096);
-        char* dst = values_out1;
-        int scanned = 0;
-        for(scanned=0; (scanned < 100) && (it != mirror.end()); ++scanned,++it)
-        {
-            memcpy(dst, &it->first, sizeof(uint64_t));
-            dst += sizeof(uint64_t);
-            memcpy(dst, &it->second, sizeof(uint64_t));
-            dst += sizeof(uint64_t);
-        }
-
-        char* values_out2;
-        auto r2 = tree->scan(reinterpret_cast<const char*>(&k), sizeof(uint64_t),
-            100, values_out2);
-
-        if(scanned != r2 || memcmp(values_out1, values_out2, r2*(sizeof(uint64_t)+sizeof(uint64_t))) != 0)
-        {
-            std::cout << "Different result for scan." << std::endl;
-            exit(1);
-        }
+        tree_oracle_t oracle(num_records, key_size, value_size, key_prefix, rnd_seed);
+        ok = check_oracle(tree, oracle, num_ops, num_threads, scan_size, rnd_seed);
     }
 
+    if(!ok)
+        exit(1);
+
     // TODO: Close the tree and try to recover
 
     std::cout << "Success!" << std::endl;
 
+    delete tree;
     return 0;
 }
-
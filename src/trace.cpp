@@ -0,0 +1,51 @@
+#include "trace.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace
+{
+/// Counters of every thread that ever recorded an event.
+std::vector<trace_counters_t*> registry;
+std::mutex registry_mutex;
+} // namespace
+
+extern "C" trace_counters_t* pibench_trace_local()
+{
+    // Counters are never freed, so they remain valid after the thread exits.
+    static thread_local trace_counters_t* local = nullptr;
+    if (local == nullptr)
+    {
+        local = new trace_counters_t();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(local);
+    }
+    return local;
+}
+
+namespace PiBench
+{
+
+trace_snapshot_t trace_snapshot()
+{
+    trace_snapshot_t s;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto c : registry)
+    {
+        for (size_t i = 0; i < TRACE_EVENTS; ++i)
+        {
+            s.count[i] += c->count[i].load(std::memory_order_relaxed);
+            s.nanos[i] += c->nanos[i].load(std::memory_order_relaxed);
+        }
+    }
+    return s;
+}
+
+const char* trace_event_name(size_t e)
+{
+    static const char* NAMES[TRACE_EVENTS] = {
+        "Splits", "Merges", "Restarts", "Lock waits", "Retrains", "Flushes", "Allocations"
+    };
+    return e < TRACE_EVENTS ? NAMES[e] : "Unknown";
+}
+} // namespace PiBench
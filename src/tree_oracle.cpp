@@ -0,0 +1,134 @@
+#include "tree_oracle.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <omp.h>
+
+namespace PiBench
+{
+
+namespace
+{
+/// SplitMix64 step, used to expand (id, version) into value bytes.
+inline uint64_t splitmix64(uint64_t& x) noexcept
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+} // namespace
+
+tree_oracle_t::tree_oracle_t(uint64_t num_ids, uint32_t key_size, uint32_t value_size, const std::string& prefix, uint32_t seed)
+    : state_(num_ids, 0),
+      wrapped_(false),
+      keys_(num_ids, key_size, 1, false, prefix),
+      key_size_(key_size),
+      value_size_(value_size),
+      seed_(seed),
+      integer_order_(prefix.empty() && (key_size == 4 || key_size == 8))
+{
+}
+
+void tree_oracle_t::value(uint64_t id, char* dst) const
+{
+    uint64_t x = (id << VERSION_BITS | (state_[id - 1] & VERSION_MASK)) ^ (static_cast<uint64_t>(seed_) << 40);
+    for (uint32_t i = 0; i < value_size_; i += sizeof(uint64_t))
+    {
+        auto r = splitmix64(x);
+        memcpy(dst + i, &r, std::min<size_t>(sizeof(uint64_t), value_size_ - i));
+    }
+}
+
+bool tree_oracle_t::insert(uint64_t id) noexcept
+{
+    auto& s = state_[id - 1];
+    if (s & PRESENT)
+        return false;
+    s = next_version(s);
+    return true;
+}
+
+bool tree_oracle_t::update(uint64_t id) noexcept
+{
+    auto& s = state_[id - 1];
+    if (!(s & PRESENT))
+        return false;
+    s = next_version(s);
+    return true;
+}
+
+bool tree_oracle_t::remove(uint64_t id) noexcept
+{
+    auto& s = state_[id - 1];
+    if (!(s & PRESENT))
+        return false;
+    s &= VERSION_MASK;
+    return true;
+}
+
+uint32_t tree_oracle_t::next_version(uint32_t s) noexcept
+{
+    if ((s & VERSION_MASK) == VERSION_MASK)
+        wrapped_.store(true, std::memory_order_relaxed);
+    return PRESENT | ((s + 1) & VERSION_MASK);
+}
+
+uint64_t tree_oracle_t::rank(uint64_t id) const noexcept
+{
+    // Same truncation as key_generator_t: keep the low order Bytes.
+    uint64_t h = utils::multiplicative_hash<uint64_t>(id);
+    if (key_size_ < sizeof(uint64_t))
+        h &= (1ull << (key_size_ * 8)) - 1;
+
+    // Byte-wise order compares the least significant Byte first.
+    return integer_order_ ? h : __builtin_bswap64(h);
+}
+
+void tree_oracle_t::sort(uint32_t num_threads)
+{
+    const uint64_t n = state_.size();
+    order_.resize(n);
+
+    auto by_rank = [this](uint64_t a, uint64_t b) { return rank(a) < rank(b); };
+
+    // Sort chunks in parallel, then merge pairs of chunks level by level.
+    const uint64_t chunks = std::max<uint32_t>(num_threads, 1);
+    const uint64_t chunk_sz = (n + chunks - 1) / chunks;
+
+    #pragma omp parallel for num_threads(chunks)
+    for (uint64_t c = 0; c < chunks; ++c)
+    {
+        uint64_t begin = std::min(n, c * chunk_sz);
+        uint64_t end = std::min(n, begin + chunk_sz);
+        for (uint64_t i = begin; i < end; ++i)
+            order_[i] = i + 1;
+        std::sort(order_.begin() + begin, order_.begin() + end, by_rank);
+    }
+
+    for (uint64_t width = chunk_sz; width < n; width *= 2)
+    {
+        #pragma omp parallel for num_threads(chunks)
+        for (uint64_t begin = 0; begin < n; begin += 2 * width)
+        {
+            uint64_t middle = std::min(n, begin + width);
+            uint64_t end = std::min(n, begin + 2 * width);
+            std::inplace_merge(order_.begin() + begin, order_.begin() + middle, order_.begin() + end, by_rank);
+        }
+    }
+}
+
+size_t tree_oracle_t::scan(uint64_t id, size_t scan_sz, uint64_t* ids_out) const
+{
+    auto r = rank(id);
+    auto it = std::lower_bound(order_.begin(), order_.end(), r,
+                               [this](uint64_t a, uint64_t r) { return rank(a) < r; });
+
+    size_t scanned = 0;
+    for (; scanned < scan_sz && it != order_.end(); ++it)
+        if (present(*it))
+            ids_out[scanned++] = *it;
+    return scanned;
+}
+} // namespace PiBench
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "arrival_schedule.hpp"
+
+using namespace PiBench;
+
+namespace
+{
+
+TEST(ArrivalScheduleTest, Parse)
+{
+    arrival_schedule_t s;
+    std::string error;
+    EXPECT_TRUE(arrival_schedule_t::parse("const:1000:1;ramp:0:2000:2", 1, s, error));
+    EXPECT_DOUBLE_EQ(s.duration(), 3.0);
+
+    EXPECT_FALSE(arrival_schedule_t::parse("", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("flat:1000:1", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("const:1000", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("const:abc:1", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("const:-5:1", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("const:5:0", 1, s, error));
+    EXPECT_FALSE(arrival_schedule_t::parse("sine:100:200:1:1", 1, s, error));
+}
+
+TEST(ArrivalScheduleTest, Rate)
+{
+    arrival_schedule_t s;
+    std::string error;
+    ASSERT_TRUE(arrival_schedule_t::parse("const:1000:1;ramp:0:2000:2;sine:500:100:4:4", 1, s, error));
+
+    EXPECT_DOUBLE_EQ(s.rate(0.5), 1000.0);
+    EXPECT_DOUBLE_EQ(s.rate(1.0), 0.0);
+    EXPECT_DOUBLE_EQ(s.rate(2.0), 1000.0);
+    EXPECT_NEAR(s.rate(3.0), 500.0, 1e-9);
+    EXPECT_NEAR(s.rate(4.0), 600.0, 1e-9);
+    EXPECT_NEAR(s.rate(6.0), 400.0, 1e-9);
+    EXPECT_DOUBLE_EQ(s.rate(7.0), 0.0);
+
+    // 1000 + 2000 + 4 * 500 (full period).
+    EXPECT_NEAR(s.expected_arrivals(), 5000.0, 1e-6);
+}
+
+TEST(ArrivalScheduleTest, Burst)
+{
+    arrival_schedule_t s1, s2;
+    std::string error;
+    ASSERT_TRUE(arrival_schedule_t::parse("burst:100:10000:10:40:10", 7, s1, error));
+    ASSERT_TRUE(arrival_schedule_t::parse("burst:100:10000:10:40:10", 7, s2, error));
+
+    // Same seed, same switch times.
+    for (double t = 0; t < 10; t += 0.001)
+    {
+        EXPECT_EQ(s1.rate(t), s2.rate(t));
+        EXPECT_TRUE(s1.rate(t) == 100.0 || s1.rate(t) == 10000.0);
+    }
+
+    // High state 20% of the time on average.
+    double expected = 10 * (0.8 * 100 + 0.2 * 10000);
+    EXPECT_NEAR(s1.expected_arrivals(), expected, expected * 0.3);
+}
+
+TEST(ArrivalScheduleTest, Arrivals)
+{
+    arrival_schedule_t s;
+    std::string error;
+    ASSERT_TRUE(arrival_schedule_t::parse("const:20000:1;const:0:1;ramp:0:40000:1", 1, s, error));
+
+    // Two streams with half of the rate each.
+    uint64_t counts[3] = {0, 0, 0};
+    for (int stream = 0; stream < 2; ++stream)
+    {
+        std::mt19937_64 rnd(stream);
+        double prev = 0;
+        for (double t = s.next_arrival(0, 0.5, rnd); t < s.duration(); t = s.next_arrival(t, 0.5, rnd))
+        {
+            EXPECT_GE(t, prev);
+            prev = t;
+            ++counts[static_cast<int>(t)];
+        }
+    }
+
+    EXPECT_NEAR(counts[0], 20000, 600);
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[2], 20000, 600);
+}
+} // namespace
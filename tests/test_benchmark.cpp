@@ -0,0 +1,370 @@
+#include "gtest/gtest.h"
+#include "benchmark.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace PiBench;
+
+namespace
+{
+
+/// Tree keeping records in a map, counting inserts.
+class map_tree_t : public tree_api
+{
+public:
+    bool find(const char* key, size_t sz, char* value_out) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = records_.find(std::string(key, sz));
+        if (it == records_.end())
+            return false;
+        memcpy(value_out, it->second.data(), it->second.size());
+        return true;
+    }
+
+    bool insert(const char* key, size_t key_sz, const char* value, size_t value_sz) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++inserts;
+        return records_.emplace(std::string(key, key_sz), std::string(value, value_sz)).second;
+    }
+
+    bool update(const char* key, size_t key_sz, const char* value, size_t value_sz) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = records_.find(std::string(key, key_sz));
+        if (it == records_.end())
+            return false;
+        it->second.assign(value, value_sz);
+        return true;
+    }
+
+    bool remove(const char* key, size_t key_sz) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return records_.erase(std::string(key, key_sz)) == 1;
+    }
+
+    int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) override { return 0; }
+
+    uint64_t inserts = 0;
+
+protected:
+    std::mutex mutex_;
+    std::map<std::string, std::string> records_;
+};
+
+/// Map tree also supporting the integer entry points, counting their inserts.
+class u64_tree_t : public map_tree_t
+{
+public:
+    uint64_t capabilities() const override { return TREE_CAP_U64; }
+
+    bool find_u64(uint64_t key, uint64_t& value_out) override
+    {
+        return find(reinterpret_cast<const char*>(&key), sizeof(key), reinterpret_cast<char*>(&value_out));
+    }
+
+    bool insert_u64(uint64_t key, uint64_t value) override
+    {
+        ++u64_inserts;
+        return insert(reinterpret_cast<const char*>(&key), sizeof(key), reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    bool update_u64(uint64_t key, uint64_t value) override
+    {
+        return update(reinterpret_cast<const char*>(&key), sizeof(key), reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    bool remove_u64(uint64_t key) override
+    {
+        return remove(reinterpret_cast<const char*>(&key), sizeof(key));
+    }
+
+    uint64_t u64_inserts = 0;
+};
+
+options_t secondary_options()
+{
+    options_t opt;
+    opt.num_records = 1000;
+    opt.num_ops = 10000;
+    opt.num_threads = 1;
+    opt.enable_pcm = false;
+    opt.latency_sampling = 0.0;
+    opt.key_size = 8;
+    opt.value_size = 8;
+    return opt;
+}
+
+TEST(SecondaryIndexTest, InsertsCappedAtReservedIds)
+{
+    // The operation table draws 62.5% inserts for a ratio of 60%, about 250
+    // more inserts than the ids reserved for the thread.
+    auto opt = secondary_options();
+    opt.read_ratio = 0.4;
+    opt.insert_ratio = 0.6;
+
+    map_tree_t primary;
+    map_tree_t secondary;
+    std::ostringstream out;
+    benchmark_t bench(&primary, opt);
+    bench.set_output(out);
+    bench.load();
+    auto result = bench.run_secondary_index(&secondary);
+
+    uint64_t reserved = 10 + opt.num_ops * opt.insert_ratio;
+    EXPECT_EQ(primary.inserts, opt.num_records + reserved);
+    EXPECT_EQ(secondary.inserts, opt.num_records + reserved);
+    EXPECT_EQ(result.operations, opt.num_ops);
+    EXPECT_GT(result.failed, 0);
+}
+
+/// Load and read all records, returns the number of failed reads.
+uint64_t load_and_read(u64_tree_t& tree, options_t opt)
+{
+    opt.num_records = 1000;
+    opt.num_ops = 1000;
+    opt.num_threads = 1;
+    opt.enable_pcm = false;
+    opt.latency_sampling = 0.0;
+    opt.value_size = 8;
+    opt.read_ratio = 1.0;
+    opt.insert_ratio = 0.0;
+    opt.update_ratio = 0.0;
+
+    std::ostringstream out;
+    benchmark_t bench(&tree, opt);
+    bench.set_output(out);
+    bench.load();
+    if (opt.bm_mode == PiBench::mode_t::Time)
+        return 0;
+    return bench.run().failed;
+}
+
+TEST(IntegerKeysTest, Used)
+{
+    options_t opt;
+    opt.key_size = 8;
+    u64_tree_t tree;
+    EXPECT_EQ(load_and_read(tree, opt), 0);
+    EXPECT_EQ(tree.u64_inserts, 1000);
+}
+
+TEST(IntegerKeysTest, NotUsedWithPrefix)
+{
+    // Keys of 8 Bytes including the prefix are not integers.
+    options_t opt;
+    opt.key_size = 6;
+    opt.key_prefix = "ab";
+    u64_tree_t tree;
+    EXPECT_EQ(load_and_read(tree, opt), 0);
+    EXPECT_EQ(tree.u64_inserts, 0);
+    EXPECT_EQ(tree.inserts, 1000);
+}
+
+TEST(KeyPrefixTest, KeptByAllWorkers)
+{
+    // Worker threads other than the one constructing the key generator must
+    // also prepend the prefix, or their reads miss.
+    options_t opt;
+    opt.num_records = 1000;
+    opt.num_ops = 1000;
+    opt.num_threads = 2;
+    opt.enable_pcm = false;
+    opt.latency_sampling = 0.0;
+    opt.key_size = 6;
+    opt.key_prefix = "ab";
+    opt.value_size = 8;
+    opt.read_ratio = 1.0;
+    opt.insert_ratio = 0.0;
+    opt.update_ratio = 0.0;
+
+    map_tree_t tree;
+    std::ostringstream out;
+    benchmark_t bench(&tree, opt);
+    bench.set_output(out);
+    bench.load();
+    EXPECT_EQ(bench.run().failed, 0);
+}
+
+TEST(IntegerKeysTest, NotUsedInTimeMode)
+{
+    // Keys of 8 Bytes including the tid are not integers.
+    options_t opt;
+    opt.key_size = 7;
+    opt.bm_mode = PiBench::mode_t::Time;
+    u64_tree_t tree;
+    load_and_read(tree, opt);
+    EXPECT_EQ(tree.u64_inserts, 0);
+    EXPECT_EQ(tree.inserts, 1000);
+}
+
+/// Ordered map tree whose scans return records, reporting RECORD_BYTES of memory per record.
+class range_tree_t : public map_tree_t
+{
+public:
+    static constexpr uint64_t RECORD_BYTES = 64;
+
+    uint64_t capabilities() const override { return TREE_CAP_STATS; }
+
+    int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) override
+    {
+        static thread_local std::string results;
+        ++scans_;
+        int n = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results.clear();
+            for (auto it = records_.lower_bound(std::string(key, key_sz)); it != records_.end() && n < scan_sz; ++it, ++n)
+                results += it->first + it->second;
+        }
+        values_out = &results[0];
+
+        // Scans stay in flight while held and for scan_us, so stats() called next to them sees them.
+        while (hold.load())
+            ;
+        if (scan_us > 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(scan_us));
+        --scans_;
+        return n;
+    }
+
+    void stats(tree_stats_t& stats) override
+    {
+        ++calls;
+        if (scans_.load() > 0)
+            ++concurrent_calls;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.records = records_.size();
+        stats.memory_bytes = records_.size() * RECORD_BYTES;
+    }
+
+    uint64_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return records_.size();
+    }
+
+    /// Scans in flight, raised before they read and lowered once released.
+    uint32_t in_flight() const { return scans_.load(); }
+
+    std::atomic<bool> hold{false};
+    uint32_t scan_us = 0;
+    uint64_t calls = 0;
+    uint64_t concurrent_calls = 0;
+
+private:
+    std::atomic<uint32_t> scans_{0};
+};
+
+options_t range_remove_options()
+{
+    options_t opt;
+    opt.num_records = 1000;
+    opt.num_ops = 1000;
+    opt.num_threads = 1;
+    opt.enable_pcm = false;
+    opt.latency_sampling = 0.0;
+    opt.key_size = 8;
+    opt.value_size = 8;
+    opt.read_ratio = 0.0;
+    opt.remove_range_size = 10;
+    return opt;
+}
+
+/// Number following 'label' in a report.
+double report_value(const std::string& report, const std::string& label)
+{
+    auto pos = report.find(label);
+    if (pos == std::string::npos)
+        return -1;
+    return std::stod(report.substr(pos + label.size()));
+}
+
+TEST(RangeRemoveTest, StatsSeeScansInFlight)
+{
+    range_tree_t tree;
+    tree.hold = true;
+    std::thread scanner([&] {
+        char key[8] = {};
+        char* values_out = nullptr;
+        tree.scan(key, sizeof(key), 1, values_out);
+    });
+    while (tree.in_flight() == 0)
+        ;
+
+    tree_stats_t stats;
+    tree.stats(stats);
+    tree.hold = false;
+    scanner.join();
+    EXPECT_EQ(tree.concurrent_calls, 1);
+}
+
+TEST(RangeRemoveTest, FallbackRemovesRecords)
+{
+    auto opt = range_remove_options();
+    opt.remove_range_ratio = 1.0;
+
+    range_tree_t tree;
+    std::ostringstream out;
+    benchmark_t bench(&tree, opt);
+    bench.set_output(out);
+    bench.load();
+    bench.run();
+
+    auto removed = report_value(out.str(), "Records removed: ");
+    EXPECT_GT(removed, 0);
+    EXPECT_EQ(removed, opt.num_records - tree.size());
+    EXPECT_GT(report_value(out.str(), "Time per removed record: "), 0);
+    EXPECT_EQ(report_value(out.str(), "Memory released per removed record: "), range_tree_t::RECORD_BYTES);
+    EXPECT_EQ(out.str().find("distorted"), std::string::npos);
+    EXPECT_EQ(tree.calls, 2);
+}
+
+TEST(RangeRemoveTest, NoStatsNextToLongScans)
+{
+    auto opt = range_remove_options();
+    opt.num_ops = 500;
+    opt.remove_range_ratio = 1.0;
+    opt.long_scan_threads = 2;
+
+    // Long scans are in flight almost all the time the workers run.
+    range_tree_t tree;
+    tree.scan_us = 1000;
+    std::ostringstream out;
+    benchmark_t bench(&tree, opt);
+    bench.set_output(out);
+    bench.load();
+    bench.run_long_scans();
+
+    // Only the baseline run samples statistics, before and after.
+    EXPECT_EQ(tree.calls, 2);
+    EXPECT_EQ(tree.concurrent_calls, 0);
+    EXPECT_GT(report_value(out.str(), "Records removed: "), 0);
+}
+
+TEST(RangeRemoveTest, MemoryDistortedByInserts)
+{
+    auto opt = range_remove_options();
+    opt.insert_ratio = 0.9;
+    opt.remove_range_ratio = 0.1;
+
+    range_tree_t tree;
+    std::ostringstream out;
+    benchmark_t bench(&tree, opt);
+    bench.set_output(out);
+    bench.load();
+    bench.run();
+
+    EXPECT_EQ(tree.calls, 2);
+    EXPECT_GT(report_value(out.str(), "Records removed: "), 0);
+    EXPECT_NE(out.str().find("(distorted by inserts of the run)"), std::string::npos);
+}
+} // namespace
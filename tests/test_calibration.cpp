@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "calibration.hpp"
+
+#include <fstream>
+
+using namespace PiBench;
+
+namespace
+{
+
+calibration_t measured()
+{
+    calibration_t c;
+    c.l1_bytes = 16 << 10;
+    c.l2_bytes = 512 << 10;
+    c.llc_bytes = 8 << 20;
+    c.dram_bytes = 256 << 20;
+    c.l1_ns = 1;
+    c.l2_ns = 4;
+    c.llc_ns = 20;
+    c.dram_ns = 90;
+    c.read_gbs = 20;
+    c.write_gbs = 10;
+    c.cas_mops_single = 100;
+    c.cas_mops_contended = 20;
+    c.cas_threads = 2;
+    c.clock_ns = 20;
+    c.tsc_ns = 7;
+    return c;
+}
+
+/// Load a calibration from a file holding 'content', returns the error or "" if loaded.
+std::string load(const std::string& content, calibration_t& c)
+{
+    auto path = testing::TempDir() + "calibration.txt";
+    std::ofstream(path) << content;
+    std::string error;
+    return c.load(path, error) ? "" : error;
+}
+
+TEST(CalibrationTest, SaveLoad)
+{
+    auto path = testing::TempDir() + "calibration.txt";
+    ASSERT_TRUE(measured().save(path));
+
+    calibration_t c;
+    std::string error;
+    ASSERT_TRUE(c.load(path, error)) << error;
+    EXPECT_DOUBLE_EQ(c.dram_ns, 90);
+    EXPECT_DOUBLE_EQ(c.remote_dram_ns, 0);
+    EXPECT_DOUBLE_EQ(c.cas_threads, 2);
+}
+
+/// 'text' with the first 'from' replaced by 'to'.
+std::string replaced(std::string text, const std::string& from, const std::string& to)
+{
+    return text.replace(text.find(from), from.size(), to);
+}
+
+TEST(CalibrationTest, Invalid)
+{
+    auto path = testing::TempDir() + "calibration.txt";
+    ASSERT_TRUE(measured().save(path));
+    std::ifstream f(path);
+    std::string saved((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    calibration_t c;
+    EXPECT_EQ(load("", c), "measurement 'l1_bytes' is missing");
+    EXPECT_EQ(load(saved.substr(0, saved.find("\ndram_ns") + 1), c), "measurement 'dram_ns' is missing");
+    EXPECT_EQ(load(saved + "dram_ns 90\n", c), "measurement 'dram_ns' is repeated");
+    EXPECT_EQ(load(saved + "unknown 1\n", c), "measurement 'unknown' is not known");
+    EXPECT_EQ(load(replaced(saved, "pool_read_ns 0", "pool_read_ns"), c), "measurement 'pool_read_ns' is not a number");
+    EXPECT_EQ(load(replaced(saved, "pool_read_ns 0", "pool_read_ns abc"), c), "measurement 'pool_read_ns' is not a number");
+    EXPECT_EQ(load(replaced(saved, "pool_read_ns 0", "pool_read_ns nan"), c), "measurement 'pool_read_ns' is not a number");
+    EXPECT_NE(load(replaced(saved, "pool_read_ns 0", "pool_read_ns -1"), c).find("must not be negative"), std::string::npos);
+    EXPECT_NE(load(replaced(saved, "\ndram_ns 90", "\ndram_ns 0"), c).find("must be positive"), std::string::npos);
+
+    // Failed loads leave measurements unchanged.
+    EXPECT_DOUBLE_EQ(c.dram_ns, 0);
+    EXPECT_EQ(load(replaced(saved, "pool_read_ns 0", "pool_read_ns 300"), c), "");
+    EXPECT_DOUBLE_EQ(c.pool_read_ns, 300);
+}
+} // namespace
@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include "expiry.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+using namespace PiBench;
+
+namespace
+{
+
+/// Tree keeping keys in a set, values are ignored.
+class set_tree_t : public tree_api
+{
+public:
+    bool find(const char* key, size_t sz, char* value_out) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return keys_.count(std::string(key, sz)) == 1;
+    }
+
+    bool insert(const char* key, size_t key_sz, const char* value, size_t value_sz) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return keys_.insert(std::string(key, key_sz)).second;
+    }
+
+    bool update(const char* key, size_t key_sz, const char* value, size_t value_sz) override { return false; }
+
+    bool remove(const char* key, size_t key_sz) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return keys_.erase(std::string(key, key_sz)) == 1;
+    }
+
+    int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) override { return 0; }
+
+private:
+    std::mutex mutex_;
+    std::set<std::string> keys_;
+};
+
+TEST(ExpiryTest, RemovesExpiredRecords)
+{
+    set_tree_t tree;
+    uniform_key_generator_t keys(100, 8, 1, false);
+    char key[key_generator_t::KEY_MAX];
+    for (uint64_t id = 1; id <= 10; ++id)
+    {
+        keys.key_of(id, key);
+        ASSERT_TRUE(tree.insert(key, keys.size(), nullptr, 0));
+    }
+
+    expiry_t expiry(&tree, keys, 2, 100);
+    expiry.start();
+
+    // Odd ids expire right away, even ids only after an hour.
+    for (uint64_t id = 1; id <= 10; ++id)
+        expiry.add(id % 2, id, id % 2 ? 0 : 3600e9);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!expiry.expired(9) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    expiry.stop();
+
+    EXPECT_EQ(expiry.registered(), 10);
+    EXPECT_EQ(expiry.removed(), 5);
+    EXPECT_EQ(expiry.failed(), 0);
+    EXPECT_EQ(expiry.pending(), 5);
+    EXPECT_EQ(expiry.lag_ns().size(), 5);
+
+    for (uint64_t id = 1; id <= 10; ++id)
+    {
+        keys.key_of(id, key);
+        EXPECT_EQ(expiry.expired(id), id % 2 == 1);
+        EXPECT_EQ(tree.find(key, keys.size(), nullptr), id % 2 == 0);
+    }
+    EXPECT_FALSE(expiry.expired(1000));
+}
+
+TEST(ExpiryTest, MissingRecordsFail)
+{
+    set_tree_t tree;
+    uniform_key_generator_t keys(100, 8, 1, false);
+
+    expiry_t expiry(&tree, keys, 1, 100);
+    expiry.start();
+    expiry.add(0, 42, 0);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!expiry.expired(42) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    expiry.stop();
+
+    EXPECT_TRUE(expiry.expired(42));
+    EXPECT_EQ(expiry.removed(), 0);
+    EXPECT_EQ(expiry.failed(), 1);
+}
+} // namespace
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "benchmark.hpp"
+#include "key_generator.hpp"
+
+using namespace PiBench;
+
+namespace
+{
+
+TEST(KeyMixtureTest, Parse)
+{
+    std::vector<key_component_t> m;
+    std::string error;
+    ASSERT_TRUE(parse_key_mixture("zipfian:0.99@0.8+UNIFORM@0.2", 0.2, m, error));
+    ASSERT_EQ(m.size(), 2);
+    EXPECT_EQ(m[0].distribution, distribution_t::ZIPFIAN);
+    EXPECT_FLOAT_EQ(m[0].skew, 0.99);
+    EXPECT_DOUBLE_EQ(m[0].weight, 0.8);
+    EXPECT_EQ(m[1].distribution, distribution_t::UNIFORM);
+    EXPECT_DOUBLE_EQ(m[1].weight, 0.2);
+
+    ASSERT_TRUE(parse_key_mixture("SELFSIMILAR", 0.3, m, error));
+    ASSERT_EQ(m.size(), 1);
+    EXPECT_FLOAT_EQ(m[0].skew, 0.3);
+    EXPECT_DOUBLE_EQ(m[0].weight, 1.0);
+
+    EXPECT_FALSE(parse_key_mixture("", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("NORMAL", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("ZIPFIAN:abc", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("ZIPFIAN:1.5", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("SELFSIMILAR:0.7", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("UNIFORM@0", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("ZIPFIAN:0.9x", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("UNIFORM@1@2", 0.2, m, error));
+    EXPECT_FALSE(parse_key_mixture("UNIFORM:0.5", 0.2, m, error));
+}
+
+TEST(KeyMixtureTest, Weights)
+{
+    // Narrow component draws ids up to 10, wide component up to 1000000.
+    std::vector<std::pair<std::unique_ptr<key_generator_t>, double>> components;
+    components.emplace_back(std::make_unique<uniform_key_generator_t>(10, 8, 1, false), 3.0);
+    components.emplace_back(std::make_unique<uniform_key_generator_t>(1000000, 8, 1, false), 1.0);
+    mixture_key_generator_t gen(1000000, 8, 1, false, "", std::move(components));
+    key_generator_t::set_seed(1729);
+
+    const int N = 100000;
+    int narrow = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        gen.next(false);
+        narrow += key_generator_t::last_id_ <= 10;
+    }
+    EXPECT_NEAR((double)narrow / N, 0.75, 0.01);
+}
+
+TEST(KeyMixtureTest, PerOperation)
+{
+    // Reads draw id 1 only, all other operations ids up to 1000000.
+    std::vector<std::unique_ptr<key_generator_t>> generators;
+    generators.push_back(std::make_unique<uniform_key_generator_t>(1, 8, 1, false));
+    for (size_t i = 1; i <= static_cast<size_t>(operation_t::SEEK); ++i)
+        generators.push_back(std::make_unique<uniform_key_generator_t>(1000000, 8, 1, false));
+    operation_key_generator_t gen(1000000, 8, 1, false, "", std::move(generators));
+    key_generator_t::set_seed(1729);
+
+    operation_key_generator_t::select(operation_t::READ);
+    for (int i = 0; i < 100; ++i)
+    {
+        gen.next(false);
+        EXPECT_EQ(key_generator_t::last_id_, 1);
+    }
+
+    operation_key_generator_t::select(operation_t::UPDATE);
+    int other = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        gen.next(false);
+        other += key_generator_t::last_id_ != 1;
+    }
+    EXPECT_GT(other, 90);
+}
+} // namespace
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "linearizability_checker.hpp"
+
+#include <vector>
+
+using namespace PiBench;
+
+namespace
+{
+
+class LinearizabilityCheckerTest : public ::testing::Test
+{
+protected:
+    LinearizabilityCheckerTest()
+        : checker_([](uint64_t key, uint64_t& value) {
+              // Key 0 starts empty, key 1 starts with value 1.
+              value = key;
+              return key == 1;
+          })
+    {
+    }
+
+    static history_event_t Event(uint64_t key, history_op_t op, uint64_t value, bool result,
+                                 uint64_t invoke, uint64_t response)
+    {
+        history_event_t e;
+        e.key = key;
+        e.op = op;
+        e.value = value;
+        e.result = result;
+        e.invoke = invoke;
+        e.response = response;
+        return e;
+    }
+
+    linearizability_checker_t::result_t
+    Check(const std::vector<std::vector<history_event_t>>& threads)
+    {
+        std::vector<const std::vector<history_event_t>*> histories;
+        for (auto& t : threads)
+            histories.push_back(&t);
+        return checker_.check(histories);
+    }
+
+    linearizability_checker_t checker_;
+};
+
+TEST_F(LinearizabilityCheckerTest, Sequential)
+{
+    auto r = Check({{
+        Event(0, history_op_t::FIND, 0, false, 1, 2),
+        Event(0, history_op_t::INSERT, 10, true, 3, 4),
+        Event(0, history_op_t::INSERT, 11, false, 5, 6),
+        Event(0, history_op_t::FIND, 10, true, 7, 8),
+        Event(1, history_op_t::UPDATE, 12, true, 9, 10),
+        Event(1, history_op_t::FIND, 12, true, 11, 12),
+        Event(1, history_op_t::REMOVE, 0, true, 13, 14),
+        Event(1, history_op_t::REMOVE, 0, false, 15, 16),
+    }});
+
+    EXPECT_EQ(r.keys, 2);
+    EXPECT_EQ(r.operations, 8);
+    EXPECT_TRUE(r.violations.empty());
+    EXPECT_TRUE(r.inconclusive.empty());
+}
+
+TEST_F(LinearizabilityCheckerTest, StaleRead)
+{
+    // The find starts after the update returned but still sees the old value.
+    auto r = Check({
+        {Event(1, history_op_t::UPDATE, 20, true, 1, 2)},
+        {Event(1, history_op_t::FIND, 1, true, 3, 4)},
+    });
+
+    ASSERT_EQ(r.violations.size(), 1);
+    EXPECT_EQ(r.violations[0], 1);
+}
+
+TEST_F(LinearizabilityCheckerTest, OverlappingOperations)
+{
+    // Overlapping operations may take effect in any order.
+    auto r = Check({
+        {Event(0, history_op_t::INSERT, 30, true, 1, 10)},
+        {Event(0, history_op_t::FIND, 0, false, 2, 3),
+         Event(0, history_op_t::FIND, 30, true, 4, 5)},
+        {Event(0, history_op_t::REMOVE, 0, false, 6, 7)},
+    });
+
+    // The failed remove must happen before the insert, but the find at
+    // [4,5] already saw the insert, so no order explains both.
+    ASSERT_EQ(r.violations.size(), 1);
+
+    r = Check({
+        {Event(0, history_op_t::INSERT, 30, true, 1, 10)},
+        {Event(0, history_op_t::FIND, 0, false, 2, 3),
+         Event(0, history_op_t::FIND, 30, true, 4, 5)},
+        {Event(0, history_op_t::REMOVE, 0, true, 6, 7)},
+        {Event(0, history_op_t::FIND, 0, false, 8, 9)},
+    });
+    EXPECT_TRUE(r.violations.empty());
+}
+
+TEST_F(LinearizabilityCheckerTest, DuplicateInsert)
+{
+    // Two concurrent inserts on the same key cannot both succeed.
+    auto r = Check({
+        {Event(0, history_op_t::INSERT, 40, true, 1, 4)},
+        {Event(0, history_op_t::INSERT, 41, true, 2, 3)},
+    });
+    EXPECT_EQ(r.violations.size(), 1);
+}
+
+} // namespace
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "multi_process.hpp"
+
+#include <sstream>
+
+using namespace PiBench;
+
+namespace
+{
+
+/// Tree finding every key, loaded by the calling process only.
+class found_tree_t : public tree_api
+{
+public:
+    bool find(const char* key, size_t sz, char* value_out) override { return true; }
+    bool insert(const char* key, size_t key_sz, const char* value, size_t value_sz) override { return true; }
+    bool update(const char* key, size_t key_sz, const char* value, size_t value_sz) override { return true; }
+    bool remove(const char* key, size_t key_sz) override { return true; }
+    int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) override { return 0; }
+};
+
+TEST(MultiProcessTest, RunsAfterParallelLoad)
+{
+    // Death tests re-execute the test binary, so no other test has run
+    // OpenMP regions in the process forking the workers.
+    testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_EXIT(
+        {
+            options_t opt;
+            opt.library_file = DUMMY_WRAPPER_PATH;
+            opt.num_processes = 2;
+            opt.num_threads = 2;
+            opt.num_records = 4000;
+            opt.num_ops = 10000;
+            opt.growth_start = 1000;
+            opt.probe_ops = 1000;
+            opt.enable_pcm = false;
+            opt.latency_sampling = 0.0;
+
+            tree_options_t tree_opt;
+            tree_opt.key_size = opt.key_size;
+            tree_opt.value_size = opt.value_size;
+            tree_opt.num_threads = opt.num_threads;
+
+            multi_process_t processes(tree_opt, opt);
+
+            // Growth curves probe the tree from an OpenMP region before the workers are released.
+            found_tree_t tree;
+            std::ostringstream out;
+            benchmark_t bench(&tree, opt);
+            bench.set_output(out);
+            bench.load_growth();
+
+            processes.run();
+            exit(0);
+        },
+        testing::ExitedWithCode(0), "");
+}
+} // namespace
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "request_ring.hpp"
+
+#include <thread>
+
+using namespace PiBench;
+
+namespace
+{
+
+TEST(RequestRingTest, Capacity)
+{
+    spsc_ring_t<uint64_t> ring(5);
+    EXPECT_EQ(ring.capacity(), 8);
+    EXPECT_TRUE(ring.empty());
+
+    for (uint64_t i = 0; i < 8; ++i)
+        EXPECT_TRUE(ring.try_push(i));
+    EXPECT_FALSE(ring.try_push(8));
+    EXPECT_FALSE(ring.empty());
+
+    uint64_t v;
+    EXPECT_TRUE(ring.try_pop(v));
+    EXPECT_EQ(v, 0);
+    EXPECT_TRUE(ring.try_push(8));
+}
+
+TEST(RequestRingTest, Batch)
+{
+    spsc_ring_t<uint64_t> ring(16);
+    for (uint64_t i = 0; i < 10; ++i)
+        ring.try_push(i);
+
+    uint64_t out[16];
+    EXPECT_EQ(ring.pop_batch(out, 4), 4);
+    for (uint64_t i = 0; i < 4; ++i)
+        EXPECT_EQ(out[i], i);
+
+    EXPECT_EQ(ring.pop_batch(out, 16), 6);
+    for (uint64_t i = 0; i < 6; ++i)
+        EXPECT_EQ(out[i], i + 4);
+
+    EXPECT_EQ(ring.pop_batch(out, 16), 0);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RequestRingTest, ProducerConsumer)
+{
+    constexpr uint64_t N = 1000000;
+    spsc_ring_t<uint64_t> ring(64);
+
+    std::thread producer([&ring] {
+        for (uint64_t i = 0; i < N; ++i)
+            while (!ring.try_push(i))
+                std::this_thread::yield();
+    });
+
+    // Elements must arrive in order, none lost or duplicated.
+    uint64_t expected = 0;
+    uint64_t out[32];
+    while (expected < N)
+    {
+        auto n = ring.pop_batch(out, 32);
+        if (n == 0)
+            std::this_thread::yield();
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(out[i], expected++);
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+} // namespace
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "tree_oracle.hpp"
+#include "utils.hpp"
+
+#include <cstring>
+#include <map>
+
+using namespace PiBench;
+
+namespace
+{
+
+TEST(TreeOracleTest, Transitions)
+{
+    tree_oracle_t oracle(10, 8, 16, "", 1729);
+    EXPECT_EQ(oracle.size(), 10);
+    EXPECT_EQ(oracle.key_size(), 8);
+    EXPECT_FALSE(oracle.present(3));
+
+    EXPECT_FALSE(oracle.update(3));
+    EXPECT_FALSE(oracle.remove(3));
+    EXPECT_TRUE(oracle.insert(3));
+    EXPECT_FALSE(oracle.insert(3));
+    EXPECT_TRUE(oracle.present(3));
+
+    char v1[16], v2[16];
+    oracle.value(3, v1);
+    EXPECT_TRUE(oracle.update(3));
+    oracle.value(3, v2);
+    EXPECT_NE(memcmp(v1, v2, sizeof(v1)), 0);
+
+    // Re-inserting after a remove must not resurrect an old value.
+    EXPECT_TRUE(oracle.remove(3));
+    EXPECT_FALSE(oracle.present(3));
+    EXPECT_TRUE(oracle.insert(3));
+    oracle.value(3, v1);
+    EXPECT_NE(memcmp(v1, v2, sizeof(v1)), 0);
+}
+
+TEST(TreeOracleTest, ManyUpdates)
+{
+    // Values of an id must not repeat within many updates, or lost updates go undetected.
+    tree_oracle_t oracle(1, 8, 16, "", 1729);
+    ASSERT_TRUE(oracle.insert(1));
+    char first[16], v[16];
+    oracle.value(1, first);
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_TRUE(oracle.update(1));
+        oracle.value(1, v);
+        ASSERT_NE(memcmp(first, v, sizeof(v)), 0) << "after " << i + 1 << " updates";
+    }
+    EXPECT_FALSE(oracle.wrapped());
+}
+
+TEST(TreeOracleTest, Keys)
+{
+    tree_oracle_t oracle(10, 8, 8, "user_", 1729);
+    EXPECT_EQ(oracle.key_size(), 13);
+    EXPECT_FALSE(oracle.integer_order());
+
+    char key[13];
+    oracle.key(7, key);
+    EXPECT_EQ(memcmp(key, "user_", 5), 0);
+    uint64_t id_part;
+    memcpy(&id_part, key + 5, sizeof(id_part));
+    EXPECT_EQ(id_part, utils::multiplicative_hash<uint64_t>(7));
+}
+
+TEST(TreeOracleTest, Scan)
+{
+    const uint64_t N = 1000;
+    tree_oracle_t oracle(N, 8, 8, "", 1729);
+    EXPECT_TRUE(oracle.integer_order());
+
+    // Reference ordering of present ids.
+    std::map<uint64_t, uint64_t> mirror;
+    for (uint64_t id = 1; id <= N; id += 3)
+    {
+        oracle.insert(id);
+        mirror[utils::multiplicative_hash<uint64_t>(id)] = id;
+    }
+    oracle.sort(4);
+
+    uint64_t ids[50];
+    for (uint64_t start = 1; start <= N; start += 37)
+    {
+        auto scanned = oracle.scan(start, 50, ids);
+        auto it = mirror.lower_bound(utils::multiplicative_hash<uint64_t>(start));
+        size_t expected = 0;
+        for (; expected < 50 && it != mirror.end(); ++expected, ++it)
+            EXPECT_EQ(ids[expected], it->second);
+        EXPECT_EQ(scanned, expected);
+    }
+}
+
+} // namespace
@@ -3,14 +3,19 @@
 
 #include "tree_api.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <type_traits>
 #include <map>
+#include <memory>
 #include <cstring>
 #include <array>
 #include <mutex>
 #include <shared_mutex>
+#include <utility>
+#include <vector>
 
 template<typename Key, typename T>
 class stlmap_wrapper : public tree_api
@@ -25,9 +30,103 @@ public:
     virtual bool remove(const char* key, size_t key_sz) override;
     virtual int scan(const char* key, size_t key_sz, int scan_sz, char*& values_out) override;
 
+    virtual uint64_t capabilities() const override
+    {
+        uint64_t caps = TREE_CAP_SNAPSHOT | TREE_CAP_STATS | TREE_CAP_MULTIMAP | TREE_CAP_AGGREGATE | TREE_CAP_REMOVE_RANGE
+                        | TREE_CAP_TRANSACTIONS | TREE_CAP_HINT | TREE_CAP_SEEK;
+        if constexpr (IS_U64)
+            caps |= TREE_CAP_U64;
+        return caps;
+    }
+    virtual void* snapshot_begin() override;
+    virtual int snapshot_scan(void* snapshot, const char* key, size_t key_sz, int scan_sz, char*& values_out) override;
+    virtual void snapshot_end(void* snapshot) override;
+    virtual size_t snapshot_bytes(void* snapshot) override;
+    virtual void stats(tree_stats_t& stats) override;
+    virtual bool insert_dup(const char* key, size_t key_sz, const char* value, size_t value_sz) override;
+    virtual int find_all(const char* key, size_t key_sz, char*& values_out) override;
+    virtual bool remove_one(const char* key, size_t key_sz, const char* value, size_t value_sz) override;
+    virtual int remove_all(const char* key, size_t key_sz) override;
+    virtual void aggregate(const char* key, size_t key_sz, uint64_t range_sz, tree_aggregate_t& result) override;
+    virtual uint64_t remove_range(const char* key, size_t key_sz, uint64_t range_sz) override;
+    virtual void* txn_begin() override;
+    virtual bool txn_read(void* txn, const char* key, size_t key_sz, char* value_out) override;
+    virtual bool txn_write(void* txn, const char* key, size_t key_sz, const char* value, size_t value_sz) override;
+    virtual bool txn_commit(void* txn) override;
+    virtual void txn_abort(void* txn) override;
+    virtual void* hint_create() override;
+    virtual void hint_destroy(void* hint) override;
+    virtual bool find_hint(void* hint, const char* key, size_t sz, char* value_out) override;
+    virtual bool insert_hint(void* hint, const char* key, size_t key_sz, const char* value, size_t value_sz) override;
+    virtual uint64_t hint_hits(void* hint) override;
+    virtual bool lower_bound(const char* key, size_t key_sz, char* key_out, char* value_out) override;
+    virtual bool upper_bound(const char* key, size_t key_sz, char* key_out, char* value_out) override;
+    virtual bool predecessor(const char* key, size_t key_sz, char* key_out, char* value_out) override;
+    virtual bool find_u64(uint64_t key, uint64_t& value_out) override;
+    virtual bool insert_u64(uint64_t key, uint64_t value) override;
+    virtual bool update_u64(uint64_t key, uint64_t value) override;
+    virtual bool remove_u64(uint64_t key) override;
+
 private:
-    std::map<Key,T> map_;
+    /// Whether keys and values are 8-Byte integers, so typed entry points are supported.
+    static constexpr bool IS_U64 = std::is_same<Key, uint64_t>::value && std::is_same<T, uint64_t>::value;
+
+    /// Records are kept in a multimap, so duplicates can be inserted with insert_dup().
+    using map_t = std::multimap<Key,T>;
+
+    /// Snapshots are full copies of the map taken under the shared lock.
+    struct snapshot_t
+    {
+        map_t map;
+        size_t bytes;
+    };
+
+    /// Optimistic transactions: reads are validated and writes applied at commit, under the exclusive lock.
+    struct txn_t
+    {
+        /// Records read from the map and the values observed.
+        std::vector<std::pair<Key,T>> reads;
+
+        /// Records written, applied in order at commit.
+        std::vector<std::pair<Key,T>> writes;
+    };
+
+    /// Position of the last record visited, valid while no record was erased since.
+    struct hint_t
+    {
+        typename map_t::iterator it;
+        uint64_t epoch = 0;
+        bool valid = false;
+        uint64_t hits = 0;
+    };
+
+    /// Records a hint may step over before falling back to a lookup from the root.
+    static constexpr uint32_t HINT_STEPS = 16;
+
+    /// Find the first record not less than 'k' near a hint, the lock must be held.
+    bool hint_lower_bound(const hint_t& hint, const Key& k, typename map_t::iterator& pos);
+
+    /// Copy a value of the map to a buffer.
+    static void copy_value(const T& value, char* value_out);
+
+    /// Copy a record of the map to key and value buffers.
+    static void copy_record(const typename map_t::value_type& record, char* key_out, char* value_out);
+
+    /// Copy records of 'map' starting from 'key' to a thread-local buffer.
+    static int scan_map(const map_t& map, const char* key, size_t key_sz, int scan_sz, char*& values_out);
+
+    /// Estimate memory used by nodes of 'map' and by heap-allocated strings.
+    static size_t map_bytes(const map_t& map);
+
+    /// Convert a key or value to its type in the map.
+    static Key to_key(const char* key, size_t key_sz);
+    static T to_value(const char* value, size_t value_sz);
+
+    map_t map_;
     std::shared_mutex mutex_;
+
+    /// Incremented by every erase, which may invalidate iterators held by hints.
+    uint64_t erase_epoch_ = 0;
 };
 
 template<typename Key, typename T>
@@ -72,24 +171,37 @@ bool stlmap_wrapper<Key,T>::find(const char* key, size_t key_sz, char* value_out
 
 
 template<typename Key, typename T>
-bool stlmap_wrapper<Key, T>::insert(const char* key, size_t key_sz, const char* value, size_t value_sz)
+Key stlmap_wrapper<Key,T>::to_key(const char* key, size_t key_sz)
 {
-    std::unique_lock lock(mutex_);
-
-    Key k;
     if constexpr (std::is_arithmetic<Key>::value)
-        k = *reinterpret_cast<Key*>(const_cast<char*>(key));
+        return *reinterpret_cast<Key*>(const_cast<char*>(key));
     else
-        k = std::string(key, key_sz);
+        return std::string(key, key_sz);
+}
 
-    T v;
+template<typename Key, typename T>
+T stlmap_wrapper<Key,T>::to_value(const char* value, size_t value_sz)
+{
     if constexpr (std::is_arithmetic<T>::value)
-        v = *reinterpret_cast<T*>(const_cast<char*>(value));
+        return *reinterpret_cast<T*>(const_cast<char*>(value));
     else
-        v = std::string(value, value_sz);
+        return std::string(value, value_sz);
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key, T>::insert(const char* key, size_t key_sz, const char* value, size_t value_sz)
+{
+    std::unique_lock lock(mutex_);
 
+    Key k = to_key(key, key_sz);
 
-    return map_.insert(std::make_pair(k,v)).second;
+    // Unique insert, the position found by lower_bound() is reused as hint.
+    auto it = map_.lower_bound(k);
+    if (it != map_.end() && it->first == k)
+        return false;
+
+    map_.emplace_hint(it, k, to_value(value, value_sz));
+    return true;
 }
 
 template<typename Key, typename T>
@@ -97,23 +209,12 @@ bool stlmap_wrapper<Key, T>::update(const char* key, size_t key_sz, const char*
 {
     std::unique_lock lock(mutex_);
 
-    typename std::map<Key,T>::iterator it;
-    if constexpr (std::is_arithmetic<Key>::value)
-        it = map_.find(*reinterpret_cast<Key*>(const_cast<char*>(key)));
-    else
-        it = map_.find(std::string(key, key_sz));
-
+    auto it = map_.find(to_key(key, key_sz));
     if (it == map_.end())
         return false;
-    else
-    {
-        if constexpr (std::is_arithmetic<T>::value)
-            it->second = *reinterpret_cast<T*>(const_cast<char*>(value));
-        else
-            it->second = std::string(value, value_sz);
 
-        return true;
-    }
+    it->second = to_value(value, value_sz);
+    return true;
 }
 
 template<typename Key, typename T>
@@ -121,17 +222,25 @@ bool stlmap_wrapper<Key,T>::remove(const char* key, size_t key_sz)
 {
     std::unique_lock lock(mutex_);
 
-    if constexpr (std::is_arithmetic<Key>::value)
-        return map_.erase(*reinterpret_cast<Key*>(const_cast<char*>(key))) == 1;
-    else
-        return map_.erase(std::string(key, key_sz)) == 1;
+    auto it = map_.find(to_key(key, key_sz));
+    if (it == map_.end())
+        return false;
+
+    map_.erase(it);
+    ++erase_epoch_;
+    return true;
 }
 
 template<typename Key, typename T>
 int stlmap_wrapper<Key,T>::scan(const char* key, size_t key_sz, int scan_sz, char*& values_out)
 {
     std::shared_lock lock(mutex_);
+    return scan_map(map_, key, key_sz, scan_sz, values_out);
+}
 
+template<typename Key, typename T>
+int stlmap_wrapper<Key,T>::scan_map(const map_t& map, const char* key, size_t key_sz, int scan_sz, char*& values_out)
+{
     constexpr size_t ONE_MB = 1ULL << 20;
     static thread_local std::array<char, ONE_MB> results;
 
@@ -139,14 +248,14 @@ int stlmap_wrapper<Key,T>::scan(const char* key, size_t key_sz, int scan_sz, cha
     char* dst = reinterpret_cast<char*>(results.data());
     if constexpr (std::is_arithmetic<Key>::value)
     {
-        auto it = map_.lower_bound(*reinterpret_cast<Key*>(const_cast<char*>(key)));
-        if (it == map_.end())
+        auto it = map.lower_bound(*reinterpret_cast<Key*>(const_cast<char*>(key)));
+        if (it == map.end())
             return 0;
 
-        for(scanned=0; (scanned < scan_sz) && (it != map_.end()); ++scanned,++it)
+        for(scanned=0; (scanned < scan_sz) && (it != map.end()); ++scanned,++it)
         {
             memcpy(dst, &it->first, sizeof(Key));
-            dst += sizeof(T);
+            dst += sizeof(Key);
 
             if constexpr (std::is_arithmetic<T>::value)
             {
@@ -162,14 +271,14 @@ int stlmap_wrapper<Key,T>::scan(const char* key, size_t key_sz, int scan_sz, cha
     }
     else
     {
-        auto it = map_.lower_bound(std::string(key, key_sz));
-        if (it == map_.end())
+        auto it = map.lower_bound(std::string(key, key_sz));
+        if (it == map.end())
             return 0;
 
-        for(scanned=0; (scanned < scan_sz) && (it != map_.end()); ++scanned,++it)
+        for(scanned=0; (scanned < scan_sz) && (it != map.end()); ++scanned,++it)
         {
             memcpy(dst, it->first.c_str(), it->first.size());
-            dst += sizeof(T);
+            dst += it->first.size();
 
             if constexpr (std::is_arithmetic<T>::value)
             {
@@ -187,4 +296,450 @@ int stlmap_wrapper<Key,T>::scan(const char* key, size_t key_sz, int scan_sz, cha
     return scanned;
 }
 
+template<typename Key, typename T>
+size_t stlmap_wrapper<Key,T>::map_bytes(const map_t& map)
+{
+    // Red-black tree node header plus the record and heap-allocated strings.
+    constexpr size_t NODE_HEADER = 32;
+    size_t bytes = map.size() * (NODE_HEADER + sizeof(typename map_t::value_type));
+    if constexpr (!std::is_arithmetic<Key>::value || !std::is_arithmetic<T>::value)
+    {
+        for (auto& [k, v] : map)
+        {
+            if constexpr (!std::is_arithmetic<Key>::value)
+                bytes += k.capacity() > 15 ? k.capacity() + 1 : 0;
+            if constexpr (!std::is_arithmetic<T>::value)
+                bytes += v.capacity() > 15 ? v.capacity() + 1 : 0;
+        }
+    }
+    return bytes;
+}
+
+template<typename Key, typename T>
+void* stlmap_wrapper<Key,T>::snapshot_begin()
+{
+    auto snapshot = new snapshot_t;
+    {
+        std::shared_lock lock(mutex_);
+        snapshot->map = map_;
+    }
+    snapshot->bytes = map_bytes(snapshot->map);
+    return snapshot;
+}
+
+template<typename Key, typename T>
+int stlmap_wrapper<Key,T>::snapshot_scan(void* snapshot, const char* key, size_t key_sz, int scan_sz, char*& values_out)
+{
+    // A snapshot is never modified, so it is read without locking.
+    return scan_map(static_cast<snapshot_t*>(snapshot)->map, key, key_sz, scan_sz, values_out);
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::snapshot_end(void* snapshot)
+{
+    delete static_cast<snapshot_t*>(snapshot);
+}
+
+template<typename Key, typename T>
+size_t stlmap_wrapper<Key,T>::snapshot_bytes(void* snapshot)
+{
+    return static_cast<snapshot_t*>(snapshot)->bytes;
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::stats(tree_stats_t& stats)
+{
+    std::shared_lock lock(mutex_);
+    stats.records = map_.size();
+    stats.memory_bytes = map_bytes(map_);
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::insert_dup(const char* key, size_t key_sz, const char* value, size_t value_sz)
+{
+    std::unique_lock lock(mutex_);
+    map_.emplace(to_key(key, key_sz), to_value(value, value_sz));
+    return true;
+}
+
+template<typename Key, typename T>
+int stlmap_wrapper<Key,T>::find_all(const char* key, size_t key_sz, char*& values_out)
+{
+    std::shared_lock lock(mutex_);
+
+    constexpr size_t ONE_MB = 1ULL << 20;
+    static thread_local std::array<char, ONE_MB> results;
+
+    // Values that do not fit in the buffer are dropped.
+    int found = 0;
+    char* dst = results.data();
+    char* end = dst + results.size();
+    auto range = map_.equal_range(to_key(key, key_sz));
+    for (auto it = range.first; it != range.second; ++it, ++found)
+    {
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            if (dst + sizeof(T) > end)
+                break;
+            memcpy(dst, &it->second, sizeof(T));
+            dst += sizeof(T);
+        }
+        else
+        {
+            if (dst + it->second.size() > end)
+                break;
+            memcpy(dst, it->second.c_str(), it->second.size());
+            dst += it->second.size();
+        }
+    }
+    values_out = results.data();
+    return found;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::remove_one(const char* key, size_t key_sz, const char* value, size_t value_sz)
+{
+    std::unique_lock lock(mutex_);
+
+    T v = to_value(value, value_sz);
+    auto range = map_.equal_range(to_key(key, key_sz));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == v)
+        {
+            map_.erase(it);
+            ++erase_epoch_;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Key, typename T>
+int stlmap_wrapper<Key,T>::remove_all(const char* key, size_t key_sz)
+{
+    std::unique_lock lock(mutex_);
+    ++erase_epoch_;
+    return map_.erase(to_key(key, key_sz));
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::aggregate(const char* key, size_t key_sz, uint64_t range_sz, tree_aggregate_t& result)
+{
+    std::shared_lock lock(mutex_);
+
+    result = tree_aggregate_t{};
+    for (auto it = map_.lower_bound(to_key(key, key_sz)); result.count < range_sz && it != map_.end(); ++it)
+    {
+        uint64_t v = 0;
+        if constexpr (std::is_arithmetic<T>::value)
+            v = it->second;
+        else
+            memcpy(&v, it->second.data(), std::min(sizeof(v), it->second.size()));
+
+        ++result.count;
+        result.sum += v;
+        result.min = std::min(result.min, v);
+        result.max = std::max(result.max, v);
+    }
+}
+
+template<typename Key, typename T>
+uint64_t stlmap_wrapper<Key,T>::remove_range(const char* key, size_t key_sz, uint64_t range_sz)
+{
+    std::unique_lock lock(mutex_);
+
+    auto first = map_.lower_bound(to_key(key, key_sz));
+    auto last = first;
+    uint64_t removed = 0;
+    for (; removed < range_sz && last != map_.end(); ++removed)
+        ++last;
+    map_.erase(first, last);
+    ++erase_epoch_;
+    return removed;
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::copy_value(const T& value, char* value_out)
+{
+    if constexpr (std::is_arithmetic<T>::value)
+        memcpy(value_out, &value, sizeof(T));
+    else
+        memcpy(value_out, value.c_str(), value.size());
+}
+
+template<typename Key, typename T>
+void* stlmap_wrapper<Key,T>::txn_begin()
+{
+    return new txn_t;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::txn_read(void* txn, const char* key, size_t key_sz, char* value_out)
+{
+    auto t = static_cast<txn_t*>(txn);
+    Key k = to_key(key, key_sz);
+
+    // Own writes first, the latest one wins.
+    for (auto it = t->writes.rbegin(); it != t->writes.rend(); ++it)
+    {
+        if (it->first == k)
+        {
+            copy_value(it->second, value_out);
+            return true;
+        }
+    }
+
+    std::shared_lock lock(mutex_);
+    auto it = map_.find(k);
+    if (it == map_.end())
+        return false;
+
+    t->reads.emplace_back(k, it->second);
+    copy_value(it->second, value_out);
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::txn_write(void* txn, const char* key, size_t key_sz, const char* value, size_t value_sz)
+{
+    static_cast<txn_t*>(txn)->writes.emplace_back(to_key(key, key_sz), to_value(value, value_sz));
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::txn_commit(void* txn)
+{
+    std::unique_ptr<txn_t> t(static_cast<txn_t*>(txn));
+    std::unique_lock lock(mutex_);
+
+    // Values are validated instead of versions, enough for values that are not reused.
+    for (auto& r : t->reads)
+    {
+        auto it = map_.find(r.first);
+        if (it == map_.end() || !(it->second == r.second))
+            return false;
+    }
+
+    for (auto& w : t->writes)
+    {
+        auto it = map_.find(w.first);
+        if (it == map_.end())
+            map_.emplace(w.first, w.second);
+        else
+            it->second = w.second;
+    }
+    return true;
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::txn_abort(void* txn)
+{
+    delete static_cast<txn_t*>(txn);
+}
+
+template<typename Key, typename T>
+void* stlmap_wrapper<Key,T>::hint_create()
+{
+    return new hint_t;
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::hint_destroy(void* hint)
+{
+    delete static_cast<hint_t*>(hint);
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::hint_lower_bound(const hint_t& hint, const Key& k, typename map_t::iterator& pos)
+{
+    if (!hint.valid || hint.epoch != erase_epoch_ || k < hint.it->first)
+        return false;
+
+    auto it = hint.it;
+    for (uint32_t step = 0; step < HINT_STEPS; ++step, ++it)
+    {
+        if (it == map_.end() || !(it->first < k))
+        {
+            pos = it;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::find_hint(void* hint, const char* key, size_t sz, char* value_out)
+{
+    std::shared_lock lock(mutex_);
+
+    auto h = static_cast<hint_t*>(hint);
+    Key k = to_key(key, sz);
+    typename map_t::iterator it;
+    if (hint_lower_bound(*h, k, it))
+        ++h->hits;
+    else
+        it = map_.lower_bound(k);
+
+    if (it == map_.end())
+        return false;
+
+    h->it = it;
+    h->epoch = erase_epoch_;
+    h->valid = true;
+    if (!(it->first == k))
+        return false;
+
+    copy_value(it->second, value_out);
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::insert_hint(void* hint, const char* key, size_t key_sz, const char* value, size_t value_sz)
+{
+    std::unique_lock lock(mutex_);
+
+    auto h = static_cast<hint_t*>(hint);
+    Key k = to_key(key, key_sz);
+    typename map_t::iterator it;
+    if (hint_lower_bound(*h, k, it))
+        ++h->hits;
+    else
+        it = map_.lower_bound(k);
+
+    bool inserted = it == map_.end() || !(it->first == k);
+    if (inserted)
+        it = map_.emplace_hint(it, k, to_value(value, value_sz));
+
+    h->it = it;
+    h->epoch = erase_epoch_;
+    h->valid = true;
+    return inserted;
+}
+
+template<typename Key, typename T>
+uint64_t stlmap_wrapper<Key,T>::hint_hits(void* hint)
+{
+    return static_cast<hint_t*>(hint)->hits;
+}
+
+template<typename Key, typename T>
+void stlmap_wrapper<Key,T>::copy_record(const typename map_t::value_type& record, char* key_out, char* value_out)
+{
+    if constexpr (std::is_arithmetic<Key>::value)
+        memcpy(key_out, &record.first, sizeof(Key));
+    else
+        memcpy(key_out, record.first.c_str(), record.first.size());
+    copy_value(record.second, value_out);
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::lower_bound(const char* key, size_t key_sz, char* key_out, char* value_out)
+{
+    std::shared_lock lock(mutex_);
+
+    auto it = map_.lower_bound(to_key(key, key_sz));
+    if (it == map_.end())
+        return false;
+
+    copy_record(*it, key_out, value_out);
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::upper_bound(const char* key, size_t key_sz, char* key_out, char* value_out)
+{
+    std::shared_lock lock(mutex_);
+
+    auto it = map_.upper_bound(to_key(key, key_sz));
+    if (it == map_.end())
+        return false;
+
+    copy_record(*it, key_out, value_out);
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::predecessor(const char* key, size_t key_sz, char* key_out, char* value_out)
+{
+    std::shared_lock lock(mutex_);
+
+    // Last record before the first greater key.
+    auto it = map_.upper_bound(to_key(key, key_sz));
+    if (it == map_.begin())
+        return false;
+
+    copy_record(*std::prev(it), key_out, value_out);
+    return true;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::find_u64(uint64_t key, uint64_t& value_out)
+{
+    if constexpr (IS_U64)
+    {
+        std::shared_lock lock(mutex_);
+
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+
+        value_out = it->second;
+        return true;
+    }
+    return false;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::insert_u64(uint64_t key, uint64_t value)
+{
+    if constexpr (IS_U64)
+    {
+        std::unique_lock lock(mutex_);
+
+        auto it = map_.lower_bound(key);
+        if (it != map_.end() && it->first == key)
+            return false;
+
+        map_.emplace_hint(it, key, value);
+        return true;
+    }
+    return false;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::update_u64(uint64_t key, uint64_t value)
+{
+    if constexpr (IS_U64)
+    {
+        std::unique_lock lock(mutex_);
+
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+
+        it->second = value;
+        return true;
+    }
+    return false;
+}
+
+template<typename Key, typename T>
+bool stlmap_wrapper<Key,T>::remove_u64(uint64_t key)
+{
+    if constexpr (IS_U64)
+    {
+        std::unique_lock lock(mutex_);
+
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+
+        map_.erase(it);
+        ++erase_epoch_;
+        return true;
+    }
+    return false;
+}
+
 #endif